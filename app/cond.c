@@ -0,0 +1,63 @@
+#include <ucx.h>
+
+#define N 10
+
+struct sem_s *mutex;
+struct cond_s *notfull, *notempty;
+int32_t in = 0, out = 0, count = 0, buffer[N];
+
+void producer(void)
+{
+	int32_t item;
+
+	for (;;) {
+		item = random();
+		ucx_sem_timedwait(mutex, WAIT_FOREVER);
+		while (count == N)
+			ucx_cond_wait(notfull, mutex, WAIT_FOREVER);
+		buffer[in] = item;
+		printf("\nproducer %d putting at %ld (%ld)", ucx_task_id(), in, item);
+		in = (in + 1) % N;
+		count++;
+		ucx_cond_signal(notempty);
+		ucx_sem_signal(mutex);
+	}
+}
+
+void consumer(void)
+{
+	int32_t item;
+
+	for (;;) {
+		ucx_sem_timedwait(mutex, WAIT_FOREVER);
+		while (count == 0) {
+			if (ucx_cond_wait(notempty, mutex, 100) == ERR_TIMEOUT)
+				printf("\nconsumer %d timeout", ucx_task_id());
+		}
+		item = buffer[out];
+		printf("\nconsumer %d getting from %ld (%ld)", ucx_task_id(), out, item);
+		out = (out + 1) % N;
+		count--;
+		ucx_cond_signal(notfull);
+		ucx_sem_signal(mutex);
+	}
+}
+
+void idle(void)
+{
+	for (;;);
+}
+
+int32_t app_main(void)
+{
+	ucx_task_spawn(idle, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(producer, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(consumer, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(consumer, DEFAULT_STACK_SIZE);
+
+	mutex = ucx_sem_create(4, 1);
+	notfull = ucx_cond_create();
+	notempty = ucx_cond_create();
+	
+	return 1;
+}
@@ -0,0 +1,67 @@
+#include <ucx.h>
+
+#define FIBERS		100
+
+/* a large corotine group, scheduled in constant time */
+struct cgroup_s *cgroup;
+struct sem_s *sem;
+uint32_t runs[FIBERS];
+
+void *cr_worker(void *arg)
+{
+	runs[cgroup->current - cgroup->crs]++;
+	
+	return 0;
+}
+
+/* a high priority corotine, only runnable when the semaphore is signaled */
+void *cr_event(void *arg)
+{
+	uint32_t n, time;
+	
+	if (ucx_cr_await(cgroup, sem, SELECT_SEM))
+		return 0;
+	
+	ucx_sem_trywait(sem);
+	ucx_cr_stats(cgroup, cr_event, &n, &time);
+	printf("event corotine (%d runs, %dus), worker runs: %d %d %d\n",
+		n, time, runs[1], runs[FIBERS / 2], runs[FIBERS - 1]);
+	
+	return 0;
+}
+
+void task0(void)
+{
+	while (1) {
+		ucx_task_delay(50);
+		ucx_sem_signal(sem);
+	}
+}
+
+void task1(void)
+{
+	int i;
+	
+	ucx_cr_add(cgroup, cr_event, 0);
+	
+	/* workers share the same function, and run in a round-robin fashion */
+	for (i = 0; i < FIBERS - 1; i++)
+		ucx_cr_add(cgroup, cr_worker, 100);
+	
+	/* run corotines in batches of 2ms, giving up the processor between them */
+	while (1) {
+		ucx_cr_run(cgroup, 0, 2000);
+		ucx_task_yield();
+	}
+}
+
+int32_t app_main(void)
+{
+	cgroup = ucx_cr_ginit_array(FIBERS);
+	sem = ucx_sem_create(10, 0);
+	
+	ucx_task_spawn(task0, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task1, DEFAULT_STACK_SIZE);
+
+	return 1;
+}
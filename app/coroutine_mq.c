@@ -42,12 +42,14 @@ void *cr2(void *arg)
 	struct message_s *pmsg;
 	char *str;
 	
-	if (ucx_mq_items(mq1) > 0) {
-		pmsg = ucx_mq_dequeue(mq1);
-		if (pmsg) {
-			str = pmsg->data;
-			printf("%s\n", str);
-		}
+	/* not scheduled again until mq1 has messages */
+	if (ucx_cr_await(cgroup, mq1, SELECT_MQ_READ))
+		return 0;
+	
+	pmsg = ucx_mq_dequeue(mq1);
+	if (pmsg) {
+		str = pmsg->data;
+		printf("%s\n", str);
 	}
 	
 	return 0;
@@ -61,6 +63,9 @@ void *cr3(void *arg)
 	float fval;
 	char str2[50];
 	
+	if (ucx_cr_await(cgroup, mq2, SELECT_MQ_READ))
+		return 0;
+	
 	while (ucx_mq_items(mq2) > 0) {
 		pmsg = ucx_mq_dequeue(mq2);
 		if (pmsg) {
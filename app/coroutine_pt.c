@@ -0,0 +1,76 @@
+#include <ucx.h>
+
+/* application coroutines, written as continuations */
+struct cgroup_s *cgroup;
+struct pipe_s *pipe1;
+
+struct cr1_local_s {
+	uint32_t round;
+	uint32_t i;
+};
+
+/* multi step logic, resuming from the last yield point */
+void *cr1(void *arg)
+{
+	struct cr1_local_s *l = CR_LOCAL(cgroup, struct cr1_local_s);
+	
+	CR_BEGIN(cgroup);
+	
+	printf("cr1: round %d started\n", l->round);
+	
+	for (l->i = 0; l->i < 3; l->i++) {
+		printf("cr1: step %d\n", l->i);
+		CR_YIELD();
+	}
+	
+	ucx_pipe_nbwrite(pipe1, "done", 4);
+	printf("cr1: round %d finished\n", l->round++);
+	CR_END();
+}
+
+/* waits (without being scheduled) for data on the pipe */
+void *cr2(void *arg)
+{
+	char data[16];
+	uint16_t s;
+	
+	CR_BEGIN(cgroup);
+	
+	CR_AWAIT(pipe1, SELECT_PIPE_READ);
+	memset(data, 0, sizeof(data));
+	s = ucx_pipe_nbread(pipe1, data, sizeof(data) - 1);
+	printf("cr2: pipe (%d): %s\n", s, data);
+	CR_END();
+}
+
+/* periodic coroutine, not scheduled while sleeping */
+void *cr3(void *arg)
+{
+	CR_BEGIN(cgroup);
+	
+	while (1) {
+		printf("cr3: tick at %dms\n", (uint32_t)ucx_uptime());
+		CR_SLEEP(500);
+	}
+	
+	CR_END();
+}
+
+/* only coroutines in this application */
+int32_t app_main(void)
+{
+	cgroup = ucx_cr_ginit();
+	
+	if (!cgroup)
+		printf("ucx_cr_ginit() failed!\n");
+	
+	ucx_cr_add_local(cgroup, cr1, 10, sizeof(struct cr1_local_s));
+	ucx_cr_add(cgroup, cr2, 10);
+	ucx_cr_add(cgroup, cr3, 10);
+	
+	pipe1 = ucx_pipe_create(32);
+
+	while (1) {
+		ucx_cr_schedule(cgroup, (void *)0);
+	}
+}
@@ -0,0 +1,68 @@
+#include <ucx.h>
+
+#define EV_SENSOR_A	(1 << 0)
+#define EV_SENSOR_B	(1 << 1)
+#define EV_SHUTDOWN	(1 << 2)
+
+struct eflags_s *events;
+
+void task0(void)
+{
+	while (1) {
+		ucx_task_delay(20);
+		printf("task 0: sensor A ready\n");
+		ucx_eflags_set(events, EV_SENSOR_A);
+	}
+}
+
+void task1(void)
+{
+	while (1) {
+		ucx_task_delay(50);
+		printf("task 1: sensor B ready\n");
+		ucx_eflags_set(events, EV_SENSOR_B);
+	}
+}
+
+/* waits for both sensors, in a single blocking call */
+void task2(void)
+{
+	uint32_t flags;
+	
+	while (1) {
+		ucx_eflags_wait(events, EV_SENSOR_A | EV_SENSOR_B, EFLAGS_ALL | EFLAGS_CLEAR, &flags, WAIT_FOREVER);
+		printf("task 2: both sensors ready (flags: %08x)\n", flags);
+	}
+}
+
+/* waits for any event, with a timeout */
+void task3(void)
+{
+	uint32_t flags;
+	
+	while (1) {
+		if (ucx_eflags_wait(events, EV_SENSOR_B | EV_SHUTDOWN, EFLAGS_ANY, &flags, 30) == ERR_TIMEOUT)
+			printf("task 3: timeout\n");
+		else
+			printf("task 3: event (flags: %08x)\n", flags);
+		ucx_task_delay(10);
+	}
+}
+
+void idle(void)
+{
+	while (1);
+}
+
+int32_t app_main(void)
+{
+	ucx_task_spawn(idle, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task0, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task1, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task2, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task3, DEFAULT_STACK_SIZE);
+	
+	events = ucx_eflags_create(0);
+
+	return 1;
+}
@@ -0,0 +1,68 @@
+#include <ucx.h>
+
+struct hrtimer_s *oneshot, *periodic;
+uint16_t worker_id;
+volatile uint64_t fired;
+volatile uint32_t periodic_count;
+
+/* runs in interrupt context: records the expiration time and wakes the worker */
+void *oneshot_cb(void *arg)
+{
+	fired = _read_us();
+	ucx_task_notify(worker_id, 1, NOTIFY_SET);
+	
+	return 0;
+}
+
+/* restarts itself every 500us */
+void *periodic_cb(void *arg)
+{
+	periodic_count++;
+	ucx_hrtimer_start(periodic, 500);
+	
+	return 0;
+}
+
+/* measures one-shot timers from 100us to 12.8ms */
+void task0(void)
+{
+	uint64_t start;
+	uint32_t usec = 100;
+	
+	if (ucx_hrtimer_start(periodic, 500) < 0) {
+		printf("task 0: no high resolution timer support\n");
+		
+		while (1)
+			ucx_task_delay(100);
+	}
+	
+	while (1) {
+		start = _read_us();
+		ucx_hrtimer_start(oneshot, usec);
+		ucx_task_notify_wait(1, WAIT_FOREVER);
+		
+		printf("task 0: %d us timer expired after %d us (periodic: %d)\n",
+			usec, (uint32_t)(fired - start), periodic_count);
+		
+		usec = usec < 10000 ? usec << 1 : 100;
+		ucx_task_delay(10);
+	}
+}
+
+void idle(void)
+{
+	while (1);
+}
+
+int32_t app_main(void)
+{
+	ucx_task_spawn(idle, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task0, DEFAULT_STACK_SIZE);
+	
+	worker_id = ucx_task_idref(task0);
+	oneshot = ucx_hrtimer_create(oneshot_cb, 0);
+	periodic = ucx_hrtimer_create(periodic_cb, 0);
+	
+	// start UCX/OS, preemptive mode
+	return 1;
+}
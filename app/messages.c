@@ -13,12 +13,9 @@ void task1(void)
 	struct message_s *pmsg;
 	
 	while (1) {
-		while (ucx_mq_items(mq1) == 0);
+		ucx_mq_recv(mq1, &pmsg, WAIT_FOREVER);
 
 		printf("task 1 enters...\n");
-		
-		if (ucx_mq_items(mq1))
-			ucx_mq_dequeue(mq1);
 
 		pmsg = &msg1;
 		pmsg->data = (void *)(size_t)val;
@@ -27,8 +24,6 @@ void task1(void)
 		sprintf(str, "hello %d from t1...", val++);
 		pmsg->data = (void *)&str;
 		ucx_mq_enqueue(mq3, pmsg);
-		
-		ucx_task_yield();
 	}
 }
 
@@ -39,17 +34,13 @@ void task2(void)
 	struct message_s *msg;
 	
 	while (1) {
-		if (ucx_mq_items(mq2) > 0) {
-			printf("task 2 enters...\n");
+		ucx_mq_recv(mq2, &msg, WAIT_FOREVER);
 
-			msg = ucx_mq_dequeue(mq2);
-			printf("message %d\n", (int)(size_t)msg->data);
-			msg = &msg1;
-			msg->data = (void *)(size_t)val++;
-			ucx_mq_enqueue(mq4, msg);
-		}
-		
-		ucx_task_yield();
+		printf("task 2 enters...\n");
+		printf("message %d\n", (int)(size_t)msg->data);
+		msg = &msg1;
+		msg->data = (void *)(size_t)val++;
+		ucx_mq_send(mq4, msg, WAIT_FOREVER);
 	}
 }
 
@@ -60,17 +51,13 @@ void task3(void)
 	struct message_s *msg;
 	
 	while (1) {
-		if (ucx_mq_items(mq3) > 0) {
-			printf("task 3 enters...\n");
-			
-			msg = ucx_mq_dequeue(mq3);
-			printf("message: %s\n", (char *)msg->data);
-			msg = &msg1;
-			msg->data = (void *)(size_t)val++;
-			ucx_mq_enqueue(mq4, msg);
-		}
-	
-		ucx_task_yield();
+		ucx_mq_recv(mq3, &msg, WAIT_FOREVER);
+
+		printf("task 3 enters...\n");
+		printf("message: %s\n", (char *)msg->data);
+		msg = &msg1;
+		msg->data = (void *)(size_t)val++;
+		ucx_mq_send(mq4, msg, WAIT_FOREVER);
 	}
 }
 
@@ -80,19 +67,15 @@ void task4(void)
 	struct message_s dummy;
 	
 	while (1) {
-		if (ucx_mq_items(mq4) > 1) {
-			printf("task 4 enters...\n");
+		ucx_mq_recv(mq4, &msg1, WAIT_FOREVER);
+		ucx_mq_recv(mq4, &msg2, WAIT_FOREVER);
 
-			msg1 = ucx_mq_dequeue(mq4);
-			msg2 = ucx_mq_dequeue(mq4);
-			printf("messages: %d %d\n", (int)(size_t)msg1->data, (int)(size_t)msg2->data);
-			
-			_delay_ms(100);
-			
-			ucx_mq_enqueue(mq1, &dummy);
-		}
+		printf("task 4 enters...\n");
+		printf("messages: %d %d\n", (int)(size_t)msg1->data, (int)(size_t)msg2->data);
+		
+		_delay_ms(100);
 		
-		ucx_task_yield();
+		ucx_mq_enqueue(mq1, &dummy);
 	}
 }
 
@@ -0,0 +1,109 @@
+#include <ucx.h>
+#include <ieee754.h>
+
+/* application tasks */
+
+enum {TYPE_STRING, TYPE_INT, TYPE_FLOAT};
+
+struct mq_s *mq1, *mq2;
+struct mpool_s *pool;
+
+void task1(void)
+{
+	int val = 0;
+	float fval = 0.0f;
+	struct message_s *pmsg;
+	
+	while (1) {
+		/* messages and their payload come from the pool, not from the heap */
+		pmsg = ucx_mq_alloc(mq1);
+		if (pmsg) {
+			sprintf(pmsg->data, "hello %d from t1...", val);
+			pmsg->type = TYPE_STRING;
+			ucx_mq_send(mq1, pmsg, WAIT_FOREVER);
+		}
+
+		val++;
+		pmsg = ucx_mq_alloc(mq2);
+		if (pmsg) {
+			itoa(val, pmsg->data, 10);
+			pmsg->type = TYPE_INT;
+			ucx_mq_send(mq2, pmsg, WAIT_FOREVER);
+		}
+		
+		fval += 0.123;
+		pmsg = ucx_mq_alloc(mq2);
+		if (pmsg) {
+			ftoa(fval, pmsg->data, 6);
+			pmsg->type = TYPE_FLOAT;
+			ucx_mq_send(mq2, pmsg, WAIT_FOREVER);
+		}
+		
+		printf("pool: %d blocks available\n", ucx_mpool_avail(pool));
+		
+		ucx_task_delay(10);
+	}
+}
+
+void task2(void)
+{
+	struct message_s *pmsg;
+	
+	while (1) {
+		ucx_mq_recv(mq1, &pmsg, WAIT_FOREVER);
+		printf("%s\n", (char *)pmsg->data);
+		ucx_mq_free(mq1, pmsg);
+	}
+}
+
+void task3(void)
+{
+	struct message_s *pmsg;
+	char *str;
+	int val;
+	float fval;
+	char str2[50];
+	
+	while (1) {
+		ucx_mq_recv(mq2, &pmsg, WAIT_FOREVER);
+		str = pmsg->data;
+		
+		switch (pmsg->type) {
+		case TYPE_INT:
+			val = atoi(str);
+			itoa(val, str2, 10);
+			break;
+		case TYPE_FLOAT:
+			fval = atof(str);
+			ftoa(fval, str2, 6);
+			break;
+		default: break;
+		}
+		
+		printf("recv str: %s converted value: %s\n", str, str2);
+		ucx_mq_free(mq2, pmsg);
+	}
+}
+
+void idle(void)
+{
+	while (1);
+}
+
+int32_t app_main(void)
+{
+	ucx_task_spawn(idle, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task1, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task2, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task3, DEFAULT_STACK_SIZE);
+	
+	mq1 = ucx_mq_create(8);
+	mq2 = ucx_mq_create(8);
+	
+	/* 16 blocks, 64 bytes each (message header + payload) shared by both queues */
+	pool = ucx_mpool_create(64, 16);
+	ucx_mq_pool(mq1, pool);
+	ucx_mq_pool(mq2, pool);
+	
+	return 1;
+}
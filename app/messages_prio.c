@@ -0,0 +1,71 @@
+#include <ucx.h>
+
+/* application tasks */
+
+enum {BAND_CONTROL, BAND_TELEMETRY, BAND_LOG};
+
+struct pmq_s *pmq;
+
+void task0(void)
+{
+	int val = 0;
+	struct message_s msg[8];
+	struct message_s *pmsg;
+	int i;
+	
+	while (1) {
+		/* bulk traffic */
+		for (i = 0; i < 6; i++) {
+			pmsg = &msg[i];
+			pmsg->data = (void *)(size_t)val++;
+			pmsg->type = i & 1 ? BAND_LOG : BAND_TELEMETRY;
+			ucx_pmq_enqueue(pmq, pmsg, pmsg->type);
+		}
+		
+		/* urgent control message, queued last */
+		pmsg = &msg[6];
+		pmsg->data = (void *)(size_t)val++;
+		pmsg->type = BAND_CONTROL;
+		ucx_pmq_enqueue(pmq, pmsg, BAND_CONTROL);
+		
+		ucx_task_delay(50);
+	}
+}
+
+void task1(void)
+{
+	struct message_s *pmsg;
+	
+	while (1) {
+		if (ucx_pmq_items(pmq, PMQ_BAND_ANY) > 0) {
+			printf("items: %d control, %d telemetry, %d log\n",
+				ucx_pmq_items(pmq, BAND_CONTROL),
+				ucx_pmq_items(pmq, BAND_TELEMETRY),
+				ucx_pmq_items(pmq, BAND_LOG));
+			
+			while ((pmsg = ucx_pmq_dequeue(pmq)))
+				printf("band %d, message %d\n", pmsg->type, (int)(size_t)pmsg->data);
+		}
+		
+		ucx_task_yield();
+	}
+}
+
+void idle(void)
+{
+	while (1);
+}
+
+int32_t app_main(void)
+{
+	ucx_task_spawn(idle, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task0, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task1, DEFAULT_STACK_SIZE);
+	
+	pmq = ucx_pmq_create(8, 3);
+	
+	if (!pmq)
+		printf("ucx_pmq_create() failed!\n");
+
+	return 1;
+}
@@ -0,0 +1,65 @@
+#include <ucx.h>
+
+#define EV_RX		(1 << 0)
+#define EV_TX		(1 << 1)
+
+uint16_t worker_id, counter_id;
+
+/* signals the worker with event bits and the counter task with increments */
+void task0(void)
+{
+	uint32_t n = 0;
+	
+	while (1) {
+		ucx_task_delay(20);
+		n++;
+		printf("task 0: notify %s\n", n & 1 ? "rx" : "tx");
+		ucx_task_notify(worker_id, n & 1 ? EV_RX : EV_TX, NOTIFY_SET);
+		ucx_task_notify(counter_id, 1, NOTIFY_INC);
+	}
+}
+
+/* waits for any event, with a timeout */
+void task1(void)
+{
+	uint32_t bits;
+	
+	while (1) {
+		bits = ucx_task_notify_wait(EV_RX | EV_TX, 30);
+		
+		if (!bits)
+			printf("task 1: timeout\n");
+		else
+			printf("task 1: event (bits: %08x)\n", bits);
+	}
+}
+
+/* consumes several counting notifications at once */
+void task2(void)
+{
+	uint32_t count;
+	
+	while (1) {
+		ucx_task_delay(100);
+		count = ucx_task_notify_wait(0xffffffff, WAIT_FOREVER);
+		printf("task 2: %d notifications\n", count);
+	}
+}
+
+void idle(void)
+{
+	while (1);
+}
+
+int32_t app_main(void)
+{
+	ucx_task_spawn(idle, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task0, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task1, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task2, DEFAULT_STACK_SIZE);
+	
+	worker_id = ucx_task_idref(task1);
+	counter_id = ucx_task_idref(task2);
+
+	return 1;
+}
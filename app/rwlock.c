@@ -0,0 +1,59 @@
+#include <ucx.h>
+
+/* shared configuration table, read by many tasks and updated by one */
+struct config_s {
+	int32_t gain;
+	int32_t offset;
+	int32_t version;
+} config;
+
+struct rwlock_s *lock;
+
+void reader(void)
+{
+	int32_t gain, offset, version;
+	
+	for (;;) {
+		ucx_rwlock_rdlock(lock, WAIT_FOREVER);
+		gain = config.gain;
+		offset = config.offset;
+		version = config.version;
+		ucx_rwlock_unlock(lock);
+		
+		printf("reader %d: version %d, gain %d, offset %d\n", ucx_task_id(), version, gain, offset);
+		ucx_task_delay(5);
+	}
+}
+
+void writer(void)
+{
+	for (;;) {
+		ucx_task_delay(50);
+		
+		ucx_rwlock_wrlock(lock, WAIT_FOREVER);
+		config.version++;
+		config.gain = config.version * 10;
+		config.offset = -config.version;
+		ucx_rwlock_unlock(lock);
+		
+		printf("writer %d: updated to version %d\n", ucx_task_id(), config.version);
+	}
+}
+
+void idle(void)
+{
+	for (;;);
+}
+
+int32_t app_main(void)
+{
+	ucx_task_spawn(idle, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(reader, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(reader, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(reader, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(writer, DEFAULT_STACK_SIZE);
+
+	lock = ucx_rwlock_create();
+	
+	return 1;
+}
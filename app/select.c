@@ -0,0 +1,97 @@
+#include <ucx.h>
+
+struct pipe_s *pipe1;
+struct mq_s *mq1;
+struct sem_s *sem1;
+
+void task0(void)
+{
+	char data[32];
+	int val = 0;
+	
+	while (1) {
+		ucx_task_delay(30);
+		sprintf(data, "pipe data %d", val++);
+		ucx_pipe_nbwrite(pipe1, data, strlen(data));
+	}
+}
+
+void task1(void)
+{
+	struct message_s msg;
+	int val = 100;
+	
+	while (1) {
+		ucx_task_delay(70);
+		msg.data = (void *)(size_t)val++;
+		ucx_mq_enqueue(mq1, &msg);
+	}
+}
+
+void task2(void)
+{
+	while (1) {
+		ucx_task_delay(110);
+		ucx_sem_signal(sem1);
+	}
+}
+
+/* a single gateway task serves all channels, without polling */
+void task3(void)
+{
+	struct select_s sel[3];
+	struct message_s *msg;
+	char data[32];
+	uint32_t ready;
+	int32_t s;
+	
+	sel[0].obj = pipe1;
+	sel[0].event = SELECT_PIPE_READ;
+	sel[1].obj = mq1;
+	sel[1].event = SELECT_MQ_READ;
+	sel[2].obj = sem1;
+	sel[2].event = SELECT_SEM;
+	
+	while (1) {
+		if (ucx_select(sel, 3, &ready, 200) == ERR_TIMEOUT) {
+			printf("timeout\n");
+			continue;
+		}
+		
+		if (ready & (1 << 0)) {
+			memset(data, 0, sizeof(data));
+			s = ucx_pipe_nbread(pipe1, data, sizeof(data) - 1);
+			printf("pipe (%d): %s\n", s, data);
+		}
+		
+		if (ready & (1 << 1)) {
+			msg = ucx_mq_dequeue(mq1);
+			printf("message: %d\n", (int)(size_t)msg->data);
+		}
+		
+		if (ready & (1 << 2)) {
+			ucx_sem_trywait(sem1);
+			printf("semaphore signaled\n");
+		}
+	}
+}
+
+void idle(void)
+{
+	while (1);
+}
+
+int32_t app_main(void)
+{
+	ucx_task_spawn(idle, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task0, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task1, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task2, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task3, DEFAULT_STACK_SIZE);
+	
+	pipe1 = ucx_pipe_create(64);
+	mq1 = ucx_mq_create(8);
+	sem1 = ucx_sem_create(4, 0);
+
+	return 1;
+}
@@ -0,0 +1,186 @@
+/*
+ * timer benchmark: creates 10, 100 and 1000 autoreload timers with mixed
+ * periods and records the firing error (against _read_us()) as a histogram,
+ * along with the CPU load of the timer handler and callbacks (measured as
+ * the idle task time lost). uptime based timers are used by default, build
+ * with -DBENCH_SYSTICK (make timer_bench_systick) to use systick timers
+ * (periods are multiples of 10ms, so they are exact at a 100Hz tick).
+ */
+
+#include <ucx.h>
+
+#define CLASSES		5
+#define BUCKETS		9
+#define RUN_SECS	5
+
+const uint32_t periods[CLASSES] = {10, 20, 50, 100, 250};	/* ms */
+const uint32_t limits[BUCKETS - 1] = {0, 100, 250, 500, 1000, 2000, 5000, 10000};	/* us */
+const char *labels[BUCKETS] = {
+	"    < 0us", "  0-100us", "100-250us", "250-500us", "0.5-1ms  ",
+	"  1-2ms  ", "  2-5ms  ", " 5-10ms  ", " >= 10ms "
+};
+
+struct class_s {
+	uint64_t start;
+	uint32_t period;
+	uint32_t count;
+	uint32_t fires;
+};
+
+struct class_s classes[CLASSES];
+uint32_t histogram[BUCKETS];
+int32_t err_min, err_max;
+int64_t err_sum;
+uint32_t samples;
+uint32_t ids[1000];
+volatile uint32_t idle_count;
+
+/*
+ * all timers in a class share the period and are started together, so the
+ * n-th expiration of a class is in period (n / count) + 1 of that class.
+ */
+void record(struct class_s *c)
+{
+	uint64_t now = _read_us();
+	uint64_t expected;
+	int32_t err;
+	int i;
+	
+	expected = c->start + (uint64_t)(c->fires / c->count + 1) * c->period * 1000;
+	c->fires++;
+	err = (int32_t)(now - expected);
+	
+	for (i = 0; i < BUCKETS - 1; i++)
+		if (err < (int32_t)limits[i])
+			break;
+	histogram[i]++;
+	
+	if (!samples || err < err_min)
+		err_min = err;
+	if (!samples || err > err_max)
+		err_max = err;
+	err_sum += err;
+	samples++;
+}
+
+void *timer0(void *arg) { record(&classes[0]); return 0; }
+void *timer1(void *arg) { record(&classes[1]); return 0; }
+void *timer2(void *arg) { record(&classes[2]); return 0; }
+void *timer3(void *arg) { record(&classes[3]); return 0; }
+void *timer4(void *arg) { record(&classes[4]); return 0; }
+
+void *(*callbacks[CLASSES])(void *) = {timer0, timer1, timer2, timer3, timer4};
+
+/* idle time (loop iterations) while the current tasks run for RUN_SECS */
+uint32_t run(void)
+{
+	uint32_t start;
+	int i;
+	
+	start = idle_count;
+	for (i = 0; i < RUN_SECS; i++)
+		ucx_task_delay(MS_TO_TICKS(1000));
+	
+	return idle_count - start;
+}
+
+void bench(uint32_t ntimers, uint32_t idle_ref)
+{
+	uint32_t idle, load, i, n = 0;
+	int c;
+	
+	samples = 0;
+	err_sum = 0;
+	for (i = 0; i < BUCKETS; i++)
+		histogram[i] = 0;
+	
+	for (c = 0; c < CLASSES; c++) {
+		classes[c].count = ntimers / CLASSES;
+		classes[c].fires = 0;
+		classes[c].period = periods[c];
+		for (i = 0; i < classes[c].count; i++) {
+#ifdef BENCH_SYSTICK
+			ids[n] = ucx_timer_create(callbacks[c], MS_TO_TICKS(periods[c]));
+#else
+			ids[n] = ucx_timer_create(callbacks[c], periods[c]);
+#endif
+			n++;
+		}
+	}
+	
+	/* start each class at once */
+	n = 0;
+	for (c = 0; c < CLASSES; c++) {
+		classes[c].start = _read_us();
+		for (i = 0; i < classes[c].count; i++)
+			ucx_timer_start(ids[n++], TIMER_AUTORELOAD);
+	}
+	
+	idle = run();
+	
+	for (i = 0; i < n; i++)
+		ucx_timer_destroy(ids[i]);
+	
+	load = idle < idle_ref && idle_ref >= 1000 ? (idle_ref - idle) / (idle_ref / 1000) : 0;
+	printf("\n%d timers: %d expirations, error min %d us, max %d us, avg %d us, load %d.%d%%\n",
+		ntimers, samples, err_min, err_max, samples ? (int32_t)(err_sum / samples) : 0,
+		load / 10, load % 10);
+	for (i = 0; i < BUCKETS; i++)
+		printf("%s %d\n", labels[i], histogram[i]);
+}
+
+/* software timer task */
+void soft_timer(void)
+{
+	while (1) {
+#ifdef BENCH_SYSTICK
+		timer_handler_systick();
+#else
+		timer_handler();
+#endif
+	}
+}
+
+void task0(void)
+{
+	uint32_t idle_ref;
+	
+	printf("timer benchmark (%s timers, %d s per run)\n",
+#ifdef BENCH_SYSTICK
+		"systick",
+#else
+		"uptime",
+#endif
+		RUN_SECS);
+	
+	/* reference: idle time without timers */
+	idle_ref = run();
+	
+	bench(10, idle_ref);
+	bench(100, idle_ref);
+	bench(1000, idle_ref);
+	
+	printf("\ndone\n");
+	
+	while (1)
+		ucx_task_delay(MS_TO_TICKS(1000));
+}
+
+void idle(void)
+{
+	while (1)
+		idle_count++;
+}
+
+int32_t app_main(void)
+{
+	ucx_task_spawn(idle, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(soft_timer, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(task0, DEFAULT_STACK_SIZE);
+	
+	ucx_task_priority(ucx_task_idref(idle), TASK_IDLE_PRIO);
+	ucx_task_priority(ucx_task_idref(soft_timer), TASK_HIGH_PRIO);
+	
+	// start UCX/OS, preemptive mode
+	return 1;
+}
@@ -0,0 +1,69 @@
+#include <ucx.h>
+
+uint32_t control_id, report_id;
+
+/* periodic control task, released every 100ms by a bound timer */
+void control(void)
+{
+	uint32_t last = 0, now, missed;
+	
+	while (1) {
+		missed = ucx_timer_wait();
+		now = ucx_uptime();
+		
+		if (last)
+			printf("control: period %d ms, missed %d\n", now - last, missed);
+		last = now;
+	}
+}
+
+/* periodic report task, released every 200ms, overruns every fourth job */
+void report(void)
+{
+	uint32_t job = 0, start;
+	
+	while (1) {
+		ucx_timer_wait();
+		job++;
+		
+		if ((job & 3) == 0) {
+			start = ucx_uptime();
+			while (ucx_uptime() - start < 300);
+		}
+		printf("report: job %d, overruns %d\n", job, ucx_task_overruns(ucx_task_id()));
+	}
+}
+
+/* software timer task */
+void soft_timer(void)
+{
+	while (1)
+		timer_handler();
+}
+
+void idle(void)
+{
+	while (1);
+}
+
+int32_t app_main(void)
+{
+	ucx_task_spawn(idle, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(soft_timer, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(control, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(report, DEFAULT_STACK_SIZE);
+	
+	ucx_task_priority(ucx_task_idref(soft_timer), TASK_HIGH_PRIO);
+	ucx_task_priority(ucx_task_idref(control), TASK_HIGH_PRIO);
+	ucx_task_priority(ucx_task_idref(report), TASK_LOW_PRIO);
+	
+	control_id = ucx_timer_create(0, 100);
+	report_id = ucx_timer_create(0, 200);
+	ucx_timer_bind_task(control_id, ucx_task_idref(control));
+	ucx_timer_bind_task(report_id, ucx_task_idref(report));
+	ucx_timer_start(control_id, TIMER_AUTORELOAD);
+	ucx_timer_start(report_id, TIMER_AUTORELOAD);
+	
+	// start UCX/OS, preemptive mode
+	return 1;
+}
@@ -0,0 +1,78 @@
+#include <ucx.h>
+
+#define SVC_CONTROL	0
+#define SVC_LOGGING	1
+
+uint32_t control_id, log_id;
+
+/* short, periodic control callback */
+void *control(void *arg)
+{
+	static uint32_t last = 0;
+	uint32_t now = ucx_uptime();
+	
+	if (last)
+		printf("control: period %d ms\n", now - last);
+	last = now;
+	
+	return 0;
+}
+
+/* slow bulk logging callback (busy for about 300ms) */
+void *logging(void *arg)
+{
+	uint32_t start = ucx_uptime();
+	
+	printf("logging: start, overruns %d\n", ucx_timer_overruns(log_id));
+	while (ucx_uptime() - start < 300);
+	printf("logging: done\n");
+	
+	return 0;
+}
+
+/* software timer task */
+void soft_timer(void)
+{
+	while (1)
+		timer_handler();
+}
+
+/* timer service tasks */
+void control_service(void)
+{
+	while (1)
+		timer_service(SVC_CONTROL);
+}
+
+void logging_service(void)
+{
+	while (1)
+		timer_service(SVC_LOGGING);
+}
+
+void idle(void)
+{
+	while (1);
+}
+
+int32_t app_main(void)
+{
+	control_id = ucx_timer_create(control, 100);
+	log_id = ucx_timer_create(logging, 200);
+	ucx_timer_service(control_id, SVC_CONTROL);
+	ucx_timer_service(log_id, SVC_LOGGING);
+	ucx_timer_start(control_id, TIMER_AUTORELOAD);
+	ucx_timer_start(log_id, TIMER_AUTORELOAD);
+	
+	ucx_task_spawn(idle, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(soft_timer, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(control_service, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(logging_service, DEFAULT_STACK_SIZE);
+	
+	ucx_task_priority(ucx_task_idref(soft_timer), TASK_HIGH_PRIO);
+	ucx_task_priority(ucx_task_idref(control_service), TASK_HIGH_PRIO);
+	ucx_task_priority(ucx_task_idref(logging_service), TASK_LOW_PRIO);
+	
+	// start UCX/OS, preemptive mode
+	return 1;
+}
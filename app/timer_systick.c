@@ -74,7 +74,7 @@ void idle(void)
 
 int32_t app_main(void)
 {
-	uint16_t id1, id2, id3, id4, id5;
+	uint32_t id1, id2, id3, id4, id5;
 
 	id1 = ucx_timer_create(timer1, MS_TO_TICKS(1000));
 	id2 = ucx_timer_create(timer2, MS_TO_TICKS(3000));
@@ -0,0 +1,74 @@
+#include <ucx.h>
+
+struct sample_s {
+	uint32_t seq;
+	int32_t value;
+};
+
+struct topic_s *sensor;
+struct mq_s *mq[3];
+
+void publisher(void)
+{
+	struct message_s *m;
+	struct sample_s *sample;
+	uint32_t seq = 0;
+	int32_t n;
+	
+	while (1) {
+		m = ucx_topic_alloc(sensor);
+		
+		if (m) {
+			sample = m->data;
+			sample->seq = seq++;
+			sample->value = random() & 0xfff;
+			n = ucx_topic_publish(sensor, m);
+			printf("published sample %d to %d subscribers\n", sample->seq, n);
+		} else {
+			printf("no buffers available\n");
+		}
+		
+		ucx_task_delay(20);
+	}
+}
+
+/* each subscriber gets a pointer to the same buffer in its own queue */
+void subscriber(void)
+{
+	struct message_s *m;
+	struct sample_s *sample;
+	int id = ucx_task_id() - 2;
+	
+	while (1) {
+		ucx_mq_recv(mq[id], &m, WAIT_FOREVER);
+		sample = m->data;
+		printf("subscriber %d: sample %d, value %d (buffer %p)\n", id, sample->seq, sample->value, m);
+		ucx_topic_release(m);
+	}
+}
+
+void idle(void)
+{
+	while (1);
+}
+
+int32_t app_main(void)
+{
+	int i;
+	
+	ucx_task_spawn(idle, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(publisher, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(subscriber, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(subscriber, DEFAULT_STACK_SIZE);
+	ucx_task_spawn(subscriber, DEFAULT_STACK_SIZE);
+	
+	/* 4 buffers, shared by all subscribers */
+	sensor = ucx_topic_create(sizeof(struct sample_s), 4);
+	
+	for (i = 0; i < 3; i++) {
+		mq[i] = ucx_mq_create(4);
+		ucx_topic_subscribe(sensor, mq[i]);
+	}
+
+	return 1;
+}
@@ -11,6 +11,7 @@
 #include <lib/dump.h>
 #include <lib/list.h>
 #include <kernel/kernel.h>
+#include <kernel/hrtimer.h>
 #include <kernel/ecodes.h>
 
 
@@ -67,6 +68,90 @@ static void tim11_start()
 	TIM_Cmd(TIM11, ENABLE);
 }
 
+/*
+ * TIM5 (32 bit, 1MHz) is used for high resolution timers. channel 1 compare
+ * is programmed with the next deadline, in chunks of up to 2^31 us.
+ */
+static volatile uint64_t hrtimer_left;
+
+static void tim5_config()
+{
+	TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStruct;
+	RCC_ClocksTypeDef RCC_Clocks;
+	uint32_t clock;
+	
+	/* Enable clock for TIM5 */
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM5, ENABLE);
+	
+	/* APB1 timers run at twice the bus clock if the bus is prescaled */
+	RCC_GetClocksFreq(&RCC_Clocks);
+	clock = RCC_Clocks.PCLK1_Frequency;
+	if (RCC_Clocks.HCLK_Frequency != RCC_Clocks.PCLK1_Frequency)
+		clock <<= 1;
+	
+	/* preset default values of the timer struct */
+	TIM_TimeBaseStructInit(&TIM_TimeBaseInitStruct);
+	
+	/* TIM5 value of prescaler, period and mode */
+	TIM_TimeBaseInitStruct.TIM_Prescaler = clock / 1000000 - 1;
+	TIM_TimeBaseInitStruct.TIM_Period = 0xffffffff;
+	TIM_TimeBaseInitStruct.TIM_ClockDivision = TIM_CKD_DIV1;
+	TIM_TimeBaseInitStruct.TIM_CounterMode = TIM_CounterMode_Up;
+	
+	/* TIM5 initialize, compare interrupt disabled */
+	TIM_TimeBaseInit(TIM5, &TIM_TimeBaseInitStruct);
+	TIM_ITConfig(TIM5, TIM_IT_CC1, DISABLE);
+	TIM_ClearITPendingBit(TIM5, TIM_IT_CC1);
+	NVIC_SetPriority(TIM5_IRQn, (1<<__NVIC_PRIO_BITS) - 1);
+	NVIC_EnableIRQ(TIM5_IRQn);
+	TIM_Cmd(TIM5, ENABLE);
+}
+
+static void tim5_arm(void)
+{
+	uint32_t chunk;
+	
+	chunk = hrtimer_left > 0x7fffffff ? 0x7fffffff : hrtimer_left;
+	hrtimer_left -= chunk;
+	TIM5->CCR1 = TIM5->CNT + chunk;
+	
+	/* compare value already passed, trigger it by software */
+	if ((int32_t)(TIM5->CNT - TIM5->CCR1) >= 0)
+		TIM_GenerateEvent(TIM5, TIM_EventSource_CC1);
+}
+
+int32_t _hrtimer_set(uint64_t deadline)
+{
+	uint64_t now;
+	
+	TIM_ITConfig(TIM5, TIM_IT_CC1, DISABLE);
+	TIM_ClearITPendingBit(TIM5, TIM_IT_CC1);
+	
+	if (!deadline)
+		return ERR_OK;
+	
+	now = _read_us();
+	hrtimer_left = deadline > now ? deadline - now : 0;
+	tim5_arm();
+	TIM_ITConfig(TIM5, TIM_IT_CC1, ENABLE);
+	
+	return ERR_OK;
+}
+
+void TIM5_IRQHandler(void)
+{
+	if (TIM_GetITStatus(TIM5, TIM_IT_CC1) != RESET) {
+		TIM_ClearITPendingBit(TIM5, TIM_IT_CC1);
+		
+		if (hrtimer_left) {
+			tim5_arm();
+		} else {
+			TIM_ITConfig(TIM5, TIM_IT_CC1, DISABLE);
+			krnl_hrtimer_handler();
+		}
+	}
+}
+
 /* delay routines */
 void _delay_ms(uint32_t msec)
 {
@@ -98,6 +183,35 @@ uint64_t _read_us(void)
 	return timeref;
 }
 
+/*
+ * cycle counter (DWT->CYCCNT), extended to 64 bits. the extension is updated
+ * with interrupts masked (PRIMASK is restored, so it can be used by interrupt
+ * handlers and inside critical sections) and the counter is also read on each
+ * system tick, so no wrap is missed.
+ */
+uint64_t _read_cycles(void)
+{
+	static uint32_t hi = 0, last = 0;
+	uint32_t cycles, primask;
+	uint64_t val;
+	
+	primask = __get_PRIMASK();
+	__disable_irq();
+	cycles = DWT->CYCCNT;
+	if (cycles < last)
+		hi++;
+	last = cycles;
+	val = ((uint64_t)hi << 32) | cycles;
+	__set_PRIMASK(primask);
+	
+	return val;
+}
+
+uint32_t _cycles_freq(void)
+{
+	return SystemCoreClock;
+}
+
 /* hardware dependent stuff and interrupt management */
 
 extern int main(void);
@@ -164,7 +278,7 @@ void TIM8_CC_IRQHandler(void) __attribute__ ((weak, alias ("Dummy_Handler")));
 void DMA1_Stream7_IRQHandler(void) __attribute__ ((weak, alias ("Dummy_Handler")));
 void FSMC_IRQHandler(void) __attribute__ ((weak, alias ("Dummy_Handler")));
 void SDIO_IRQHandler(void) __attribute__ ((weak, alias ("Dummy_Handler")));
-void TIM5_IRQHandler(void) __attribute__ ((weak, alias ("Dummy_Handler")));
+void TIM5_IRQHandler(void);
 void SPI3_IRQHandler(void) __attribute__ ((weak, alias ("Dummy_Handler")));
 void UART4_IRQHandler(void) __attribute__ ((weak, alias ("Dummy_Handler")));
 void UART5_IRQHandler(void) __attribute__ ((weak, alias ("Dummy_Handler")));
@@ -350,8 +464,9 @@ void SysTick_Handler(void)
 {
 	struct tcb_s *task = kcb->task_current->data;
 
-	// update microsecond counter
+	// update microsecond and cycle counters
 	_read_us();
+	_read_cycles();
 
 	// save current PSP, call the scheduler and get new PSP
 	task_psp = &task->context[CONTEXT_PSP];
@@ -473,11 +588,19 @@ void _hardware_init(void)
 	
 	/* set PendSV interrupt for the lowest priority */
 	NVIC_SetPriority(PendSV_IRQn, 0xFF);
+	
+	/* enable the cycle counter */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
 	/* setup TIM11 for jiffies */
 	tim11_config();
 	tim11_start();
 
+	/* setup TIM5 for high resolution timers */
+	tim5_config();
+	
 	/* configure USART */
 	usart_init(USART_PORT, USART_BAUD, 0);
 	
@@ -490,6 +613,33 @@ void _hardware_init(void)
 #endif
 }
 
+/* atomic operations (LDREX / STREX) */
+int32_t _atomic_add(volatile int32_t *ptr, int32_t val)
+{
+	int32_t old;
+	
+	do {
+		old = __LDREXW((volatile uint32_t *)ptr);
+	} while (__STREXW(old + val, (volatile uint32_t *)ptr));
+	
+	return old;
+}
+
+int32_t _atomic_cas(volatile int32_t *ptr, int32_t oldval, int32_t newval)
+{
+	int32_t val;
+	
+	do {
+		val = __LDREXW((volatile uint32_t *)ptr);
+		if (val != oldval) {
+			__CLREX();
+			break;
+		}
+	} while (__STREXW(newval, (volatile uint32_t *)ptr));
+	
+	return val;
+}
+
 void _di(void)
 {
 	asm volatile (	"cpsid i\n\t");
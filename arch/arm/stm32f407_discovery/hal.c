@@ -96,6 +96,35 @@ uint64_t _read_us(void)
 	return (timeref * (1000000 / F_TIMER));
 }
 
+/*
+ * cycle counter (DWT->CYCCNT), extended to 64 bits. the extension is updated
+ * with interrupts masked (PRIMASK is restored, so it can be used by interrupt
+ * handlers and inside critical sections) and the counter is also read on each
+ * system tick, so no wrap is missed.
+ */
+uint64_t _read_cycles(void)
+{
+	static uint32_t hi = 0, last = 0;
+	uint32_t cycles, primask;
+	uint64_t val;
+	
+	primask = __get_PRIMASK();
+	__disable_irq();
+	cycles = DWT->CYCCNT;
+	if (cycles < last)
+		hi++;
+	last = cycles;
+	val = ((uint64_t)hi << 32) | cycles;
+	__set_PRIMASK(primask);
+	
+	return val;
+}
+
+uint32_t _cycles_freq(void)
+{
+	return SystemCoreClock;
+}
+
 /* hardware dependent stuff and interrupt management */
 
 extern int main(void);
@@ -348,8 +377,9 @@ void SysTick_Handler(void)
 {
 	struct tcb_s *task = kcb->task_current->data;
 
-	// update microsecond counter
+	// update microsecond and cycle counters
 	timeref++;
+	_read_cycles();
 
 	// save current PSP, call the scheduler and get new PSP
 	task_psp = &task->context[CONTEXT_PSP];
@@ -471,6 +501,11 @@ void _hardware_init(void)
 	
 	/* set PendSV interrupt for the lowest priority */
 	NVIC_SetPriority(PendSV_IRQn, 0xFF);
+	
+	/* enable the cycle counter */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
 	GPIO_InitTypeDef GPIO_InitStructure;
 	
@@ -506,6 +541,33 @@ void _hardware_init(void)
 	GPIO_SetBits(GPIOC, GPIO_Pin_13);
 }
 
+/* atomic operations (LDREX / STREX) */
+int32_t _atomic_add(volatile int32_t *ptr, int32_t val)
+{
+	int32_t old;
+	
+	do {
+		old = __LDREXW((volatile uint32_t *)ptr);
+	} while (__STREXW(old + val, (volatile uint32_t *)ptr));
+	
+	return old;
+}
+
+int32_t _atomic_cas(volatile int32_t *ptr, int32_t oldval, int32_t newval)
+{
+	int32_t val;
+	
+	do {
+		val = __LDREXW((volatile uint32_t *)ptr);
+		if (val != oldval) {
+			__CLREX();
+			break;
+		}
+	} while (__STREXW(newval, (volatile uint32_t *)ptr));
+	
+	return val;
+}
+
 void _di(void)
 {
 	asm volatile (	"cpsid i\n\t");
@@ -34,6 +34,10 @@ void _irq_handler(void)
 
 	irq = VIC_RAWINTR;
 
+	// update cycle counter on each system tick
+	if (irq & INTMASK_TIMERINT0_1)
+		_read_cycles();
+
 	do {
 		if (irq & 0x1){
 			if (isr[i]) {
@@ -153,6 +157,35 @@ uint64_t _read_us(void)
 	return (timeref / (TIMCLK / 1000000));
 }
 
+/*
+ * cycle counter (SP804 timer 3, free running), extended to 64 bits. the
+ * extension is updated with IRQs masked (the CPSR I bit is restored, so it
+ * can be used by interrupt handlers and inside critical sections) and the
+ * counter is also read on each system tick, so no wrap is missed.
+ */
+uint64_t _read_cycles(void)
+{
+	static uint32_t hi = 0, last = 0;
+	uint32_t cycles, cpsr;
+	uint64_t val;
+	
+	__asm__ volatile ("mrs %0, cpsr" : "=r" (cpsr));
+	__asm__ volatile ("msr cpsr_c, %0" : : "r" (cpsr | 0x80) : "memory");
+	cycles = _readcounter();
+	if (cycles < last)
+		hi++;
+	last = cycles;
+	val = ((uint64_t)hi << 32) | cycles;
+	__asm__ volatile ("msr cpsr_c, %0" : : "r" (cpsr) : "memory");
+	
+	return val;
+}
+
+uint32_t _cycles_freq(void)
+{
+	return TIMCLK;
+}
+
 void _panic(void)
 {
 	volatile int * const exit_device = (int* const)0x100000;
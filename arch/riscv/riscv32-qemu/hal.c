@@ -9,6 +9,8 @@
 #include <lib/libc.h>
 #include <lib/list.h>
 #include <kernel/kernel.h>
+#include <kernel/hrtimer.h>
+#include <kernel/ecodes.h>
 
 /* hardware platform dependent stuff */
 static int __putchar(int value)		// polled putchar()
@@ -97,6 +99,32 @@ static void uart_init(uint32_t baud)
 	NS16550A_UART0_CTRL_ADDR(NS16550A_LCR) = NS16550A_LCR_8BIT;
 }
 
+#ifdef __riscv_atomic
+int32_t _atomic_add(volatile int32_t *ptr, int32_t val)
+{
+	int32_t old;
+	
+	asm volatile ("amoadd.w.aqrl %0, %2, (%1)"
+		: "=r"(old) : "r"(ptr), "r"(val) : "memory");
+	
+	return old;
+}
+
+int32_t _atomic_cas(volatile int32_t *ptr, int32_t oldval, int32_t newval)
+{
+	int32_t val, fail;
+	
+	asm volatile (	"1:	lr.w.aqrl %0, (%2)\n"
+			"	bne %0, %3, 2f\n"
+			"	sc.w.aqrl %1, %4, (%2)\n"
+			"	bnez %1, 1b\n"
+			"2:"
+		: "=&r"(val), "=&r"(fail) : "r"(ptr), "r"(oldval), "r"(newval) : "memory");
+	
+	return val;
+}
+#endif
+
 void _cpu_idle(void)
 {
 	asm volatile ("wfi");
@@ -109,19 +137,74 @@ void _panic(void)
 	while (1);
 }
 
+/*
+ * the machine timer compare register is shared by the system tick and the
+ * high resolution timer, and is programmed with the nearest of both events.
+ */
+static uint64_t tick_next = ~0ULL;
+static uint64_t hrtimer_next = 0;
+
+static void timecmp_update(void)
+{
+	if (hrtimer_next && hrtimer_next < tick_next)
+		mtimecmp_w(hrtimer_next);
+	else
+		mtimecmp_w(tick_next);
+}
+
+int32_t _hrtimer_set(uint64_t deadline)
+{
+	uint64_t now_us, now;
+	
+	now_us = _read_us();
+	now = mtime_r();
+	
+	if (!deadline)
+		hrtimer_next = 0;
+	else if (deadline <= now_us)
+		hrtimer_next = now;
+	else
+		hrtimer_next = now + (deadline - now_us) * (F_CPU / 1000000);
+	
+	timecmp_update();
+	if (hrtimer_next)
+		_timer_enable();
+	
+	return ERR_OK;
+}
+
 void _irq_handler(uint32_t cause, uint32_t epc)
 {
 	uint32_t val;
+	uint64_t now;
+	int handled = 0;
 	
 	val = read_csr(mcause);
-	if (mtime_r() > mtimecmp_r()) {
-		mtimecmp_w(mtime_r() + (F_CPU / F_TIMER));
-		krnl_dispatcher();
-	} else {
+	now = mtime_r();
+	
+	if (hrtimer_next && now >= hrtimer_next) {
+		hrtimer_next = 0;
+		timecmp_update();
+		krnl_hrtimer_handler();
+		handled = 1;
+	}
+	
+	if (now >= tick_next) {
+		if (kcb->preemptive == 'y') {
+			tick_next = now + (F_CPU / F_TIMER);
+			timecmp_update();
+			krnl_dispatcher();
+		} else {
+			tick_next = ~0ULL;
+			timecmp_update();
+		}
+		handled = 1;
+	}
+	
+	if (!handled) {
 		printf("[%x]\n", val);
 		_panic();
 	}
-
 }
 
 uint32_t _readcounter(void)
@@ -142,6 +225,25 @@ uint64_t _read_us(void)
 	return (timeref / (F_CPU / 1000000));
 }
 
+/* cycle counter (mcycle), calibrated at boot */
+uint64_t _read_cycles(void)
+{
+	uint32_t hi, lo;
+	
+	while (1) {
+		hi = read_csr(mcycleh);
+		lo = read_csr(mcycle);
+		
+		if (hi == read_csr(mcycleh))
+			return ((uint64_t) hi << 32) | lo;
+	}
+}
+
+uint32_t _cycles_freq(void)
+{
+	return 0;
+}
+
 // https://forums.sifive.com/t/timer-and-interrupt/3456/5
 uint64_t mtime_r(void)
 {
@@ -183,7 +285,8 @@ void mtimecmp_w(uint64_t val)
 void _hardware_init(void)
 {
 	uart_init(USART_BAUD);
-	mtimecmp_w(mtime_r() + (F_CPU / F_TIMER));
+	tick_next = mtime_r() + (F_CPU / F_TIMER);
+	timecmp_update();
 	
 	_stdout_install(__putchar);
 	_stdin_install(__getchar);
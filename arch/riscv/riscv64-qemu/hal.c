@@ -9,6 +9,7 @@
 #include <lib/libc.h>
 #include <lib/list.h>
 #include <kernel/kernel.h>
+#include <kernel/hrtimer.h>
 #include <kernel/ecodes.h>
 #include <riscv.h>
 
@@ -99,6 +100,32 @@ static void uart_init(uint32_t baud)
 	NS16550A_UART0_CTRL_ADDR(NS16550A_LCR) = NS16550A_LCR_8BIT;
 }
 
+#ifdef __riscv_atomic
+int32_t _atomic_add(volatile int32_t *ptr, int32_t val)
+{
+	int32_t old;
+	
+	asm volatile ("amoadd.w.aqrl %0, %2, (%1)"
+		: "=r"(old) : "r"(ptr), "r"(val) : "memory");
+	
+	return old;
+}
+
+int32_t _atomic_cas(volatile int32_t *ptr, int32_t oldval, int32_t newval)
+{
+	int32_t val, fail;
+	
+	asm volatile (	"1:	lr.w.aqrl %0, (%2)\n"
+			"	bne %0, %3, 2f\n"
+			"	sc.w.aqrl %1, %4, (%2)\n"
+			"	bnez %1, 1b\n"
+			"2:"
+		: "=&r"(val), "=&r"(fail) : "r"(ptr), "r"(oldval), "r"(newval) : "memory");
+	
+	return val;
+}
+#endif
+
 void _cpu_idle(void)
 {
 	asm volatile ("wfi");
@@ -111,19 +138,74 @@ void _panic(void)
 	while (1);
 }
 
+/*
+ * the machine timer compare register is shared by the system tick and the
+ * high resolution timer, and is programmed with the nearest of both events.
+ */
+static uint64_t tick_next = ~0ULL;
+static uint64_t hrtimer_next = 0;
+
+static void timecmp_update(void)
+{
+	if (hrtimer_next && hrtimer_next < tick_next)
+		mtimecmp_w(hrtimer_next);
+	else
+		mtimecmp_w(tick_next);
+}
+
+int32_t _hrtimer_set(uint64_t deadline)
+{
+	uint64_t now_us, now;
+	
+	now_us = _read_us();
+	now = mtime_r();
+	
+	if (!deadline)
+		hrtimer_next = 0;
+	else if (deadline <= now_us)
+		hrtimer_next = now;
+	else
+		hrtimer_next = now + (deadline - now_us) * (F_CPU / 1000000);
+	
+	timecmp_update();
+	if (hrtimer_next)
+		_timer_enable();
+	
+	return ERR_OK;
+}
+
 void _irq_handler(uint64_t cause, uint64_t epc)
 {
 	uint64_t val;
+	uint64_t now;
+	int handled = 0;
 	
 	val = read_csr(mcause);
-	if (mtime_r() > mtimecmp_r()) {
-		mtimecmp_w(mtime_r() + (F_CPU / F_TIMER));
-		krnl_dispatcher();
-	} else {
+	now = mtime_r();
+	
+	if (hrtimer_next && now >= hrtimer_next) {
+		hrtimer_next = 0;
+		timecmp_update();
+		krnl_hrtimer_handler();
+		handled = 1;
+	}
+	
+	if (now >= tick_next) {
+		if (kcb->preemptive == 'y') {
+			tick_next = now + (F_CPU / F_TIMER);
+			timecmp_update();
+			krnl_dispatcher();
+		} else {
+			tick_next = ~0ULL;
+			timecmp_update();
+		}
+		handled = 1;
+	}
+	
+	if (!handled) {
 		printf("[%x]\n", val);
 		_panic();
 	}
-
 }
 
 uint32_t _readcounter(void)
@@ -140,6 +222,21 @@ uint64_t _read_us(void)
 	return (timeref / (F_CPU / 1000000));
 }
 
+/* cycle counter (mcycle), calibrated at boot */
+uint64_t _read_cycles(void)
+{
+	uint64_t cycles;
+	
+	asm volatile ("csrr %0, mcycle" : "=r"(cycles));
+	
+	return cycles;
+}
+
+uint32_t _cycles_freq(void)
+{
+	return 0;
+}
+
 uint64_t mtime_r(void)
 {
 	return MTIME;
@@ -210,7 +307,8 @@ void _dispatch_init(jmp_buf env)
 		w_mip(mip);
 		
 		/* set timer to the future */
-		mtimecmp_w(mtime_r() + (F_CPU / F_TIMER));
+		tick_next = mtime_r() + (F_CPU / F_TIMER);
+		timecmp_update();
 		
 		/* enable timer interrupts */
 		_timer_enable();
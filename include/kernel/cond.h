@@ -0,0 +1,9 @@
+struct cond_s {
+	struct wlist_s *wait;
+};
+
+struct cond_s *ucx_cond_create(void);
+int32_t ucx_cond_destroy(struct cond_s *c);
+int32_t ucx_cond_wait(struct cond_s *c, struct sem_s *mutex, uint16_t timeout);
+void ucx_cond_signal(struct cond_s *c);
+void ucx_cond_broadcast(struct cond_s *c);
@@ -1,18 +1,76 @@
+/* corotine priority classes (O(1) scheduler) */
+#define CR_CLASSES		32
+#define CR_CLASS(prio)		((prio) >> 3)
+#define CR_NONE			0xffff
+
 /* corotine control block */
 struct ccb_s {
 	void *(*corotine)(void *);
+	struct cgroup_s *cgroup;
+	struct select_s await;		/* object the corotine waits on (if any) */
+	struct ccb_s *anext;		/* await list links (intrusive) */
+	struct ccb_s **apprev;
+	void *local;			/* corotine local storage (continuations) */
+	uint16_t lc;			/* continuation resume point */
+	uint16_t next;			/* next runnable corotine in its class (array groups) */
+	uint32_t runs;			/* number of invocations */
+	uint64_t time;			/* accumulated execution time (cycles), in ucx_cr_run() */
+	uint32_t wake;			/* wake up time (ms), if sleeping */
 	uint8_t priority;
 	uint8_t pcounter;
+	uint8_t queued;
+	uint8_t sleeping;
+};
+
+/* run queues of an array corotine group, one per priority class */
+struct crsched_s {
+	uint32_t ready;			/* bitmap of classes with runnable corotines */
+	uint16_t head[CR_CLASSES];
+	uint16_t tail[CR_CLASSES];
 };
 
 struct cgroup_s {
-	struct list_s *crlist;
+	struct list_s *crlist;		/* list groups */
+	struct ccb_s *crs;		/* array groups (contiguous control blocks) */
+	struct crsched_s *sched;
+	struct list_s *sleepers;	/* sleeping corotines, sorted by wake up time */
+	uint32_t now;			/* time (ms) cached for sleepers, at tick 'now_tick' */
+	uint32_t now_tick;
+	struct ccb_s *current;
 	uint16_t fibers;
+	uint16_t max;
 };
 
+/*
+ * stackless continuations (protothreads). a corotine body is enclosed by
+ * CR_BEGIN() and CR_END(), and resumes from the last CR_YIELD(), CR_WAIT_UNTIL(),
+ * CR_AWAIT() or CR_SLEEP() point on the next time it is scheduled. local variables are
+ * not preserved across these points, so state must be kept in the corotine
+ * local storage (CR_LOCAL(), before CR_BEGIN()). switch statements can't be used in the body.
+ */
+#define CR_BEGIN(cg)		struct cgroup_s *__cg = (cg); struct ccb_s *__cr = __cg->current; \
+				switch (__cr->lc) { case 0:
+#define CR_YIELD()		do { __cr->lc = __LINE__; return 0; case __LINE__:; } while (0)
+#define CR_WAIT_UNTIL(cond)	do { __cr->lc = __LINE__; case __LINE__: if (!(cond)) return 0; } while (0)
+#define CR_AWAIT(obj, event)	do { __cr->lc = __LINE__; case __LINE__: \
+				if (ucx_cr_await(__cg, (obj), (event))) return 0; } while (0)
+#define CR_SLEEP(ms)		do { ucx_cr_sleep(__cg, (ms)); __cr->lc = __LINE__; return 0; case __LINE__:; } while (0)
+#define CR_END()		} __cr->lc = 0; return 0
+#define CR_LOCAL(cg, type)	((type *)(cg)->current->local)
+
 /* corotine management API */
 struct cgroup_s *ucx_cr_ginit(void);
+struct cgroup_s *ucx_cr_ginit_array(uint16_t max);
 int32_t ucx_cr_gdestroy(struct cgroup_s *cgroup);
 int32_t ucx_cr_add(struct cgroup_s *cgroup, void *(corotine)(void *), uint8_t priority);
+int32_t ucx_cr_add_local(struct cgroup_s *cgroup, void *(corotine)(void *), uint8_t priority, uint16_t lsize);
 int32_t ucx_cr_cancel(struct cgroup_s *cgroup, void *(corotine)(void *));
 int32_t ucx_cr_schedule(struct cgroup_s *cgroup, void *arg);
+int32_t ucx_cr_run(struct cgroup_s *cgroup, void *arg, uint32_t budget);
+int32_t ucx_cr_stats(struct cgroup_s *cgroup, void *(corotine)(void *), uint32_t *runs, uint32_t *time);
+int32_t ucx_cr_await(struct cgroup_s *cgroup, void *obj, uint8_t event);
+int32_t ucx_cr_sleep(struct cgroup_s *cgroup, uint32_t ms);
+int32_t ucx_cr_next_wake(struct cgroup_s *cgroup);
+int32_t krnl_await(struct ccb_s *cr, void *obj, uint8_t event);
+void krnl_await_unlink(struct ccb_s *cr);
+void krnl_cr_wakeup(struct ccb_s *cr);
@@ -17,6 +17,7 @@ enum ecodes {
 	ERR_SEM_DEALLOC,
 	ERR_SEM_OPERATION,
 	ERR_MQ_NOTEMPTY,
+	ERR_TIMEOUT,
 	ERR_UNKNOWN
 };
 
@@ -0,0 +1,16 @@
+/* event flags wait options */
+#define EFLAGS_ANY		0x00		/* wait for any flag in the mask */
+#define EFLAGS_ALL		0x01		/* wait for all flags in the mask */
+#define EFLAGS_CLEAR		0x02		/* clear matched flags on exit */
+
+struct eflags_s {
+	struct wlist_s *wait;
+	volatile uint32_t flags;
+};
+
+struct eflags_s *ucx_eflags_create(uint32_t flags);
+int32_t ucx_eflags_destroy(struct eflags_s *ef);
+uint32_t ucx_eflags_set(struct eflags_s *ef, uint32_t mask);
+uint32_t ucx_eflags_clear(struct eflags_s *ef, uint32_t mask);
+uint32_t ucx_eflags_get(struct eflags_s *ef);
+int32_t ucx_eflags_wait(struct eflags_s *ef, uint32_t mask, uint8_t options, uint32_t *flags, uint16_t timeout);
@@ -0,0 +1,14 @@
+/* high resolution (hardware) one-shot timers */
+struct hrtimer_s {
+	struct hrtimer_s *next;
+	void *(*hrtimer_cb)(void *arg);
+	void *arg;
+	uint64_t deadline;		/* absolute time (us, same base as _read_us()) */
+	uint8_t active;
+};
+
+struct hrtimer_s *ucx_hrtimer_create(void *(*hrtimer_cb)(void *arg), void *arg);
+int32_t ucx_hrtimer_destroy(struct hrtimer_s *hr);
+int32_t ucx_hrtimer_start(struct hrtimer_s *hr, uint32_t usec);
+int32_t ucx_hrtimer_cancel(struct hrtimer_s *hr);
+void krnl_hrtimer_handler(void);
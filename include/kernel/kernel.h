@@ -13,6 +13,15 @@ enum task_priorities {
 /* task states */
 enum task_states {TASK_STOPPED, TASK_READY, TASK_RUNNING, TASK_BLOCKED, TASK_SUSPENDED};
 
+/* task notification actions */
+enum task_notify_actions {NOTIFY_SET, NOTIFY_INC, NOTIFY_OVERWRITE};
+
+/* kernel wait list, waiters are linked through their TCB */
+struct wlist_s {
+	struct tcb_s *head;
+	uint16_t length;
+};
+
 /* task control block node */
 struct tcb_s {
 	void (*task)(void);
@@ -20,10 +29,19 @@ struct tcb_s {
 	size_t *stack;
 	size_t stack_sz;
 	void *rt_prio;
+	void *wdata;			/* data handed over to a task blocked on a wait list */
+	struct tcb_s *wnext;		/* wait list link */
+	struct tcb_s **wpprev;
+	struct wlist_s *wlist;		/* wait list the task is blocked on */
+	volatile uint32_t notify;	/* notification word */
+	uint32_t nmask;			/* notification bits a blocked task waits for */
+	uint32_t overruns;		/* periodic releases missed (see ucx_timer_bind_task()) */
+	uint16_t releases;		/* periodic releases not yet consumed */
 	uint16_t id;
 	uint16_t delay;
 	uint16_t priority;
 	uint8_t state;
+	uint8_t rwait;			/* blocked waiting for a periodic release */
 };
 
 /* kernel control block */
@@ -32,7 +50,8 @@ struct kcb_s {
 	struct node_s *task_current;
 	jmp_buf context;
 	int32_t (*rt_sched)(void);
-	struct list_s *timer_lst;
+	struct wlist_s *select_lst;
+	struct ccb_s *await_lst;
 	volatile uint32_t ticks;
 	uint16_t id_next;
 	char preemptive;
@@ -42,6 +61,12 @@ extern struct kcb_s *kcb;
 
 #define KRNL_SCHED_IMAX		10000
 
+/* cycle counter calibration time (if the counter frequency is unknown) */
+#define CYCLES_CALIBRATE_US	20000
+
+/* blocking calls timeout (in ticks) - 0 never blocks */
+#define WAIT_FOREVER		0xffff
+
 /* kernel API */
 #define CRITICAL_ENTER()({kcb->preemptive == 'y' ? _di() : 0; })	// shouln't be always _di()?
 #define CRITICAL_LEAVE()({kcb->preemptive == 'y' ? _ei() : 0; })	// shouln't be always _ei()?
@@ -52,9 +77,27 @@ void krnl_panic(uint32_t ecode);
 uint16_t krnl_schedule(void);
 int32_t krnl_noop_rtsched(void);
 void krnl_dispatcher(void);
+struct wlist_s *krnl_wlist_create(void);
+int32_t krnl_wlist_destroy(struct wlist_s *wlist);
+void krnl_wlist_insert(struct wlist_s *wlist, void *data, uint16_t timeout);
+int32_t krnl_wlist_yield(void);
+int32_t krnl_block(struct wlist_s *wlist, void *data, uint16_t timeout);
+struct tcb_s *krnl_unblock(struct wlist_s *wlist);
+struct tcb_s *krnl_release(struct tcb_s *task);
+struct tcb_s *krnl_task_lookup(uint16_t id);
+int32_t krnl_task_release(uint16_t id);
 /* actual dispatch/yield implementation may be platform dependent */
 void _dispatch(void);
 void _yield(void);
+/* atomic operations may be platform dependent. both return the previous value */
+int32_t _atomic_add(volatile int32_t *ptr, int32_t val);
+int32_t _atomic_cas(volatile int32_t *ptr, int32_t oldval, int32_t newval);
+/* high resolution timer hardware (absolute deadline in us, 0 disables) */
+int32_t _hrtimer_set(uint64_t deadline);
+/* cycle counter may be platform dependent (frequency 0 if unknown) */
+uint64_t _read_cycles(void);
+uint32_t _cycles_freq(void);
+void krnl_cycles_init(void);
 
 /* task management API */
 int32_t ucx_task_spawn(void *task, uint16_t stack_size);
@@ -63,6 +106,9 @@ void ucx_task_yield();
 void ucx_task_delay(uint16_t ticks);
 int32_t ucx_task_suspend(uint16_t id);
 int32_t ucx_task_resume(uint16_t id);
+int32_t ucx_task_notify(uint16_t id, uint32_t bits, uint8_t action);
+uint32_t ucx_task_notify_wait(uint32_t mask, uint16_t timeout);
+int32_t ucx_task_overruns(uint16_t id);
 int32_t ucx_task_priority(uint16_t id, uint16_t priority);
 int32_t ucx_task_rt_priority(uint16_t id, void *priority);
 uint16_t ucx_task_id();
@@ -71,5 +117,9 @@ void ucx_task_wfi();
 uint16_t ucx_task_count();
 uint32_t ucx_ticks();
 uint64_t ucx_uptime();
+uint64_t ucx_cycles(void);
+uint32_t ucx_cycles_freq(void);
+uint64_t ucx_cycles_to_ns(uint64_t cycles);
+uint64_t ucx_cycles_to_us(uint64_t cycles);
 
 int32_t app_main();
@@ -6,11 +6,37 @@ struct message_s {
 
 struct mq_s {
 	struct queue_s *queue;
+	struct wlist_s *rwait;			/* tasks blocked on an empty queue */
+	struct wlist_s *swait;			/* tasks blocked on a full queue */
+	struct mpool_s *pool;			/* message pool, optional */
 };
 
 struct mq_s *ucx_mq_create(uint16_t size);
 int32_t ucx_mq_destroy(struct mq_s *mq);
 int32_t ucx_mq_enqueue(struct mq_s *mq, struct message_s *m);
 struct message_s *ucx_mq_dequeue(struct mq_s *mq);
+int32_t ucx_mq_send(struct mq_s *mq, struct message_s *m, uint16_t timeout);
+int32_t ucx_mq_recv(struct mq_s *mq, struct message_s **m, uint16_t timeout);
 struct message_s *ucx_mq_peek(struct mq_s *mq);
 int32_t ucx_mq_items(struct mq_s *mq);
+int32_t krnl_mq_enqueue(struct mq_s *mq, struct message_s *m);
+int32_t ucx_mq_pool(struct mq_s *mq, struct mpool_s *pool);
+struct message_s *ucx_mq_alloc(struct mq_s *mq);
+int32_t ucx_mq_free(struct mq_s *mq, struct message_s *m);
+
+#define PMQ_MAX_BANDS		32
+#define PMQ_BAND_ANY		0xff
+
+/* priority message queue, band 0 has the highest priority */
+struct pmq_s {
+	struct queue_s **band;
+	uint32_t bitmap;			/* one bit per non-empty band */
+	uint8_t bands;
+};
+
+struct pmq_s *ucx_pmq_create(uint16_t size, uint8_t bands);
+int32_t ucx_pmq_destroy(struct pmq_s *pmq);
+int32_t ucx_pmq_enqueue(struct pmq_s *pmq, struct message_s *m, uint8_t band);
+struct message_s *ucx_pmq_dequeue(struct pmq_s *pmq);
+struct message_s *ucx_pmq_peek(struct pmq_s *pmq, uint8_t band);
+int32_t ucx_pmq_items(struct pmq_s *pmq, uint8_t band);
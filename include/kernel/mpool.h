@@ -0,0 +1,13 @@
+struct mpool_s {
+	void *pool;				/* memory area for all blocks, allocated on creation */
+	void *free;				/* free block list, next pointer kept in each free block */
+	uint16_t bsize;				/* block size, aligned to a pointer size */
+	uint16_t blocks;
+	uint16_t avail;
+};
+
+struct mpool_s *ucx_mpool_create(uint16_t bsize, uint16_t blocks);
+int32_t ucx_mpool_destroy(struct mpool_s *mp);
+void *ucx_mpool_alloc(struct mpool_s *mp);
+int32_t ucx_mpool_free(struct mpool_s *mp, void *block);
+int32_t ucx_mpool_avail(struct mpool_s *mp);
@@ -0,0 +1,12 @@
+struct rwlock_s {
+	struct wlist_s *rwait;			/* readers blocked on the lock */
+	struct wlist_s *wwait;			/* writers blocked on the lock */
+	int16_t readers;			/* readers holding the lock */
+	uint8_t writer;				/* a writer holds the lock */
+};
+
+struct rwlock_s *ucx_rwlock_create(void);
+int32_t ucx_rwlock_destroy(struct rwlock_s *rw);
+int32_t ucx_rwlock_rdlock(struct rwlock_s *rw, uint16_t timeout);
+int32_t ucx_rwlock_wrlock(struct rwlock_s *rw, uint16_t timeout);
+int32_t ucx_rwlock_unlock(struct rwlock_s *rw);
@@ -0,0 +1,12 @@
+/* select events */
+enum {SELECT_PIPE_READ, SELECT_PIPE_WRITE, SELECT_MQ_READ, SELECT_MQ_WRITE, SELECT_SEM};
+
+#define SELECT_MAX		32
+
+struct select_s {
+	void *obj;				/* pipe, message queue or semaphore */
+	uint8_t event;
+};
+
+int32_t ucx_select(struct select_s *sel, uint8_t n, uint32_t *ready, uint16_t timeout);
+void krnl_select_notify(void *obj);
@@ -1,20 +1,74 @@
 enum {TIMER_DISABLED, TIMER_ONESHOT, TIMER_AUTORELOAD};
 
+/* hierarchical timing wheel (systick timers): levels of 2^TWHEEL_BITS slots */
+#define TWHEEL_BITS		5
+#define TWHEEL_LEVELS		4
+#define TWHEEL_SIZE		(1 << TWHEEL_BITS)
+#define TWHEEL_MASK		(TWHEEL_SIZE - 1)
+#define TWHEEL_MAX		((1UL << (TWHEEL_BITS * TWHEEL_LEVELS)) - 1)
+
+/* deadline heap (uptime timers) */
+#define THEAP_NONE		0xffff
+#define THEAP_SCAN		16		/* timers visited to find the wakeup time */
+
+/* timer handles: slot table index (lower bits) and slot generation (upper bits) */
+#define TSLOT_BITS		16
+#define TSLOT_MASK		((1UL << TSLOT_BITS) - 1)
+#define TSLOT_MAX		TSLOT_MASK	/* slots, TSLOT_NONE is not a valid index */
+#define TSLOT_NONE		0xffff
+#define TSLOT_GEN_MASK		((1UL << (31 - TSLOT_BITS)) - 1)
+
+/* timer callback services (0 is the first service), TIMER_INLINE calls from the handler */
+#define TIMER_SERVICES		4
+#define TIMER_INLINE		0xff
+
+/* timer not bound to a task (see ucx_timer_bind_task()) */
+#define TIMER_UNBOUND		0xffff
+
 struct timer_s {
-	uint16_t timer_id;
+	uint32_t timer_id;
 	void *(*timer_cb)(void *arg);
 	uint32_t time;
 	uint32_t countdown;
 	uint64_t timecmp;
+	uint32_t expires;		/* expiration tick (timing wheel) */
+	struct timer_s *next;		/* timing wheel slot list */
+	struct timer_s **pprev;
+	uint16_t hidx;			/* deadline heap index */
+	struct timer_s *qnext;		/* service queue */
+	uint64_t arg;			/* callback argument (expiration uptime or tick), while queued */
+	uint32_t overruns;
+	uint32_t slack;			/* tolerated expiration delay */
+	uint16_t task;			/* task released on expiration, or TIMER_UNBOUND */
+	uint8_t service;
+	uint8_t pending;
 	uint8_t mode;
 };
 
+struct tslot_s {
+	struct timer_s *timer;
+	uint16_t gen;
+	uint16_t free;			/* next free slot, while the slot is free */
+};
+
+struct tservice_s {
+	struct timer_s *head;
+	struct timer_s *tail;
+	struct tcb_s *task;		/* service task, while blocked */
+};
+
 void timer_handler();
 void timer_handler_systick();
+void timer_service(uint8_t service);
 int32_t ucx_timer_create(void *(*timer_cb)(void *arg), uint32_t time);
-int32_t ucx_timer_destroy(uint16_t timer_id);
-int32_t ucx_timer_start(uint16_t timer_id, uint8_t mode);
-int32_t ucx_timer_cancel(uint16_t timer_id);
+int32_t ucx_timer_destroy(uint32_t timer_id);
+int32_t ucx_timer_start(uint32_t timer_id, uint8_t mode);
+int32_t ucx_timer_cancel(uint32_t timer_id);
+int32_t ucx_timer_slack(uint32_t timer_id, uint32_t slack);
+int32_t ucx_timer_service(uint32_t timer_id, uint8_t service);
+int32_t ucx_timer_overruns(uint32_t timer_id);
+int32_t ucx_timer_bind_task(uint32_t timer_id, uint16_t task_id);
+int32_t ucx_timer_wait(void);
 
 #if F_TIMER == 0
 #define MS_TO_TICKS(ms) (((unsigned long)(ms) * (unsigned long)(F_TIMER_FIXED)) / 1000)
@@ -0,0 +1,17 @@
+/* initial subscriber table size (grown as needed) */
+#define TOPIC_SUBS		4
+
+struct topic_s {
+	struct mq_s **subs;			/* subscriber message queues */
+	struct mpool_s *pool;			/* reference counted buffers */
+	uint16_t nsubs;
+	uint16_t size;				/* subscriber table size */
+};
+
+struct topic_s *ucx_topic_create(uint16_t size, uint16_t buffers);
+int32_t ucx_topic_destroy(struct topic_s *t);
+int32_t ucx_topic_subscribe(struct topic_s *t, struct mq_s *mq);
+int32_t ucx_topic_unsubscribe(struct topic_s *t, struct mq_s *mq);
+struct message_s *ucx_topic_alloc(struct topic_s *t);
+int32_t ucx_topic_publish(struct topic_s *t, struct message_s *m);
+int32_t ucx_topic_release(struct message_s *m);
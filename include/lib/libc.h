@@ -61,6 +61,7 @@ void *ucx_memmove(void *dst, const void *src, uint32_t n);
 int32_t ucx_memcmp(const void *cs, const void *ct, uint32_t n);
 void *ucx_memset(void *s, int32_t c, uint32_t n);
 int32_t ucx_abs(int32_t n);
+int32_t ucx_ffs(uint32_t x);
 int32_t ucx_random(void);
 void ucx_srand(uint32_t seed);
 int32_t ucx_puts(const char *str);
@@ -7,8 +7,15 @@
 #include <lib/malloc.h>
 #include <kernel/pipe.h>
 #include <kernel/semaphore.h>
+#include <kernel/mpool.h>
+#include <kernel/eflags.h>
+#include <kernel/rwlock.h>
+#include <kernel/cond.h>
+#include <kernel/select.h>
 #include <kernel/message.h>
+#include <kernel/topic.h>
 #include <kernel/timer.h>
+#include <kernel/hrtimer.h>
 #include <kernel/kernel.h>
 #include <kernel/corotine.h>
 #include <kernel/errno.h>
@@ -23,10 +23,16 @@ int32_t main(void)
 	ucx_heap_init((size_t *)&__bss_end, ((size_t)&__stack - (size_t)&__bss_end - 256));
 	printf("heap_init(), %d bytes free\n", ((size_t)&__stack - (size_t)&__bss_end - 256));
 #endif
+	krnl_cycles_init();
 	kcb->tasks = list_create();
 	
 	if (!kcb->tasks)
 		krnl_panic(ERR_KCB_ALLOC);
+	
+	kcb->select_lst = krnl_wlist_create();
+	
+	if (!kcb->select_lst)
+		krnl_panic(ERR_KCB_ALLOC);
 
 	pr = app_main();
 	setjmp(kcb->context);
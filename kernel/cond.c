@@ -0,0 +1,82 @@
+/* file:          cond.c
+ * description:   condition variables
+ * date:          10/2026
+ */
+
+#include <ucx.h>
+
+/*
+ * Condition variables are used along with a mutex (a semaphore initialized
+ * to 1) which protects the shared state. Only tasks blocked on the condition
+ * are released by a signal (or all of them, by a broadcast), in priority order.
+ */
+struct cond_s *ucx_cond_create(void)
+{
+	struct cond_s *c;
+	
+	c = malloc(sizeof(struct cond_s));
+	
+	if (!c)
+		return 0;
+	
+	c->wait = krnl_wlist_create();
+	
+	if (!c->wait) {
+		free(c);
+		return 0;
+	}
+	
+	return c;
+}
+
+int32_t ucx_cond_destroy(struct cond_s *c)
+{
+	CRITICAL_ENTER();
+	if (krnl_wlist_destroy(c->wait)) {
+		CRITICAL_LEAVE();
+		
+		return -1;
+	}
+	
+	free(c);
+	CRITICAL_LEAVE();
+	
+	return 0;
+}
+
+/*
+ * atomically releases the mutex and blocks on the condition, for at most
+ * 'timeout' ticks (WAIT_FOREVER or 0 to not block). the task is inserted in
+ * the wait list before the mutex is released, and it yields in the same
+ * critical section, so signals are never missed. the mutex is acquired again
+ * before returning, even on ERR_TIMEOUT.
+ */
+int32_t ucx_cond_wait(struct cond_s *c, struct sem_s *mutex, uint16_t timeout)
+{
+	int32_t status;
+	
+	CRITICAL_ENTER();
+	if (timeout)
+		krnl_wlist_insert(c->wait, 0, timeout);
+	krnl_sem_signal(mutex);
+	status = timeout ? krnl_wlist_yield() : ERR_TIMEOUT;
+	CRITICAL_LEAVE();
+	
+	ucx_sem_timedwait(mutex, WAIT_FOREVER);
+	
+	return status;
+}
+
+void ucx_cond_signal(struct cond_s *c)
+{
+	CRITICAL_ENTER();
+	krnl_unblock(c->wait);
+	CRITICAL_LEAVE();
+}
+
+void ucx_cond_broadcast(struct cond_s *c)
+{
+	CRITICAL_ENTER();
+	while (krnl_unblock(c->wait));
+	CRITICAL_LEAVE();
+}
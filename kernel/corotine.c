@@ -6,6 +6,16 @@
 
 #include <ucx.h>
 
+/*
+ * Corotine groups are either list groups (ucx_cr_ginit()), where control
+ * blocks are kept in a linked list and scheduled by a priority round-robin
+ * policy, or array groups (ucx_cr_ginit_array()), where control blocks are
+ * kept in a contiguous array and runnable corotines are kept in one run queue
+ * per priority class (CR_CLASS(priority), lower is more important). A bitmap
+ * of non-empty classes is used to pick the next corotine in constant time,
+ * and corotines of the same class are scheduled in a round-robin fashion.
+ */
+
 /* initialize a corotine group */
 struct cgroup_s *ucx_cr_ginit(void)
 {
@@ -23,6 +33,70 @@ struct cgroup_s *ucx_cr_ginit(void)
 		return 0;
 	}
 	
+	cgroup->sleepers = list_create();
+	
+	if (!cgroup->sleepers) {
+		list_destroy(cgroup->crlist);
+		free(cgroup);
+		return 0;
+	}
+	
+	cgroup->crs = 0;
+	cgroup->sched = 0;
+	cgroup->current = 0;
+	cgroup->now = 0;
+	cgroup->now_tick = kcb->ticks - 1;
+	cgroup->fibers = 0;
+	cgroup->max = 0;
+	
+	return cgroup;
+}
+
+/* initialize a corotine group, with room for 'max' corotines */
+struct cgroup_s *ucx_cr_ginit_array(uint16_t max)
+{
+	struct cgroup_s *cgroup;
+	int i;
+	
+	if (!max || max == CR_NONE)
+		return 0;
+	
+	cgroup = malloc(sizeof(struct cgroup_s));
+	
+	if (!cgroup)
+		return 0;
+	
+	cgroup->crs = malloc(sizeof(struct ccb_s) * max);
+	cgroup->sched = malloc(sizeof(struct crsched_s));
+	cgroup->sleepers = list_create();
+	
+	if (!cgroup->crs || !cgroup->sched || !cgroup->sleepers) {
+		if (cgroup->crs)
+			free(cgroup->crs);
+		if (cgroup->sched)
+			free(cgroup->sched);
+		if (cgroup->sleepers)
+			list_destroy(cgroup->sleepers);
+		free(cgroup);
+		return 0;
+	}
+	
+	for (i = 0; i < max; i++)
+		cgroup->crs[i].corotine = 0;
+	
+	cgroup->sched->ready = 0;
+	for (i = 0; i < CR_CLASSES; i++) {
+		cgroup->sched->head[i] = CR_NONE;
+		cgroup->sched->tail[i] = CR_NONE;
+	}
+	
+	cgroup->crlist = 0;
+	cgroup->current = 0;
+	cgroup->now = 0;
+	cgroup->now_tick = kcb->ticks - 1;
+	cgroup->fibers = 0;
+	cgroup->max = max;
+	
 	return cgroup;
 }
 
@@ -32,36 +106,206 @@ int32_t ucx_cr_gdestroy(struct cgroup_s *cgroup)
 	if (cgroup->fibers > 0)
 		return -1;
 	
-	free(cgroup->crlist);
+	if (cgroup->crs) {
+		free(cgroup->crs);
+		free(cgroup->sched);
+	} else {
+		free(cgroup->crlist);
+	}
+	list_destroy(cgroup->sleepers);
 	free(cgroup);
 	
 	return 0;
 }
 
+/* array group run queues. must be called inside a critical section */
+static void cr_enqueue(struct cgroup_s *cgroup, struct ccb_s *cr)
+{
+	struct crsched_s *sched = cgroup->sched;
+	uint16_t idx = cr - cgroup->crs;
+	uint8_t class = CR_CLASS(cr->priority);
+	
+	cr->next = CR_NONE;
+	cr->queued = 1;
+	
+	if (sched->tail[class] == CR_NONE)
+		sched->head[class] = idx;
+	else
+		cgroup->crs[sched->tail[class]].next = idx;
+	sched->tail[class] = idx;
+	sched->ready |= (1UL << class);
+}
+
+static struct ccb_s *cr_dequeue(struct cgroup_s *cgroup)
+{
+	struct crsched_s *sched = cgroup->sched;
+	struct ccb_s *cr;
+	uint8_t class;
+	
+	if (!sched->ready)
+		return 0;
+	
+	class = ucx_ffs(sched->ready) - 1;
+	cr = &cgroup->crs[sched->head[class]];
+	sched->head[class] = cr->next;
+	
+	if (cr->next == CR_NONE) {
+		sched->tail[class] = CR_NONE;
+		sched->ready &= ~(1UL << class);
+	}
+	cr->queued = 0;
+	
+	return cr;
+}
+
+static void cr_unlink(struct cgroup_s *cgroup, struct ccb_s *cr)
+{
+	struct crsched_s *sched = cgroup->sched;
+	uint16_t idx = cr - cgroup->crs;
+	uint16_t prev = CR_NONE, i;
+	uint8_t class = CR_CLASS(cr->priority);
+	
+	for (i = sched->head[class]; i != CR_NONE && i != idx; i = cgroup->crs[i].next)
+		prev = i;
+	
+	if (i == CR_NONE)
+		return;
+	
+	if (prev == CR_NONE)
+		sched->head[class] = cr->next;
+	else
+		cgroup->crs[prev].next = cr->next;
+	
+	if (sched->tail[class] == idx)
+		sched->tail[class] = prev;
+	
+	if (sched->head[class] == CR_NONE)
+		sched->ready &= ~(1UL << class);
+	cr->queued = 0;
+}
+
+/*
+ * makes an array group corotine runnable again, when the object it awaits
+ * becomes ready. must be called inside a critical section.
+ */
+void krnl_cr_wakeup(struct ccb_s *cr)
+{
+	if (cr->cgroup->crs && !cr->queued && cr->cgroup->current != cr)
+		cr_enqueue(cr->cgroup, cr);
+}
+
+/*
+ * sleeping corotines are kept in a list sorted by wake up time (in ms), so
+ * only the first one has to be checked before scheduling. sleeping corotines
+ * are skipped by list groups and are not in the run queues of array groups.
+ * in preemptive mode the time is read once per system tick and cached, so
+ * scheduling passes don't read the uptime (a corotine wakes up to one tick
+ * late). the tick doesn't run in cooperative mode, so it is read every time.
+ */
+static uint32_t cr_now(struct cgroup_s *cgroup)
+{
+	if (kcb->preemptive != 'y' || cgroup->now_tick != kcb->ticks) {
+		cgroup->now_tick = kcb->ticks;
+		cgroup->now = ucx_uptime();
+	}
+	
+	return cgroup->now;
+}
+
+static void cr_wakeup(struct cgroup_s *cgroup)
+{
+	struct ccb_s *cr;
+	uint32_t now;
+	
+	if (!cgroup->sleepers->length)
+		return;
+	
+	now = cr_now(cgroup);
+	
+	while (cgroup->sleepers->length) {
+		cr = cgroup->sleepers->head->next->data;
+		
+		if ((int32_t)(now - cr->wake) < 0)
+			break;
+		
+		list_pop(cgroup->sleepers);
+		cr->sleeping = 0;
+		
+		if (cgroup->crs) {
+			CRITICAL_ENTER();
+			if (!cr->queued)
+				cr_enqueue(cgroup, cr);
+			CRITICAL_LEAVE();
+		}
+	}
+}
+
 /* add a corotine to a group */
 int32_t ucx_cr_add(struct cgroup_s *cgroup, void *(corotine)(void *), uint8_t priority)
+{
+	return ucx_cr_add_local(cgroup, corotine, priority, 0);
+}
+
+/* add a corotine to a group, with 'lsize' bytes of (zeroed) local storage */
+int32_t ucx_cr_add_local(struct cgroup_s *cgroup, void *(corotine)(void *), uint8_t priority, uint16_t lsize)
 {
 	struct ccb_s *cr;
 	struct node_s *node;
+	int i;
 	
-	cr = malloc(sizeof(struct ccb_s));
-	
-	if (!cr)
-		return -1;
+	if (cgroup->crs) {
+		for (i = 0; i < cgroup->max; i++)
+			if (!cgroup->crs[i].corotine)
+				break;
+		
+		if (i == cgroup->max)
+			return -1;
+		
+		cr = &cgroup->crs[i];
+		cr->local = lsize ? malloc(lsize) : 0;
+		
+		if (lsize && !cr->local)
+			return -1;
+	} else {
+		cr = malloc(sizeof(struct ccb_s) + lsize);
 		
+		if (!cr)
+			return -1;
+		
+		cr->local = lsize ? cr + 1 : 0;
+	}
+	
+	if (lsize)
+		memset(cr->local, 0, lsize);
+	
 	cr->corotine = corotine;
+	cr->cgroup = cgroup;
+	cr->lc = 0;
+	cr->await.obj = 0;
+	cr->anext = 0;
+	cr->apprev = 0;
 	cr->priority = priority;
 	cr->pcounter = priority;
+	cr->queued = 0;
+	cr->runs = 0;
+	cr->time = 0;
+	cr->sleeping = 0;
 	
-	node = list_pushback(cgroup->crlist, cr);
-	
-	if (!node) {
-		free(cr);
-		return -1;
+	if (cgroup->crs) {
+		CRITICAL_ENTER();
+		cr_enqueue(cgroup, cr);
+		CRITICAL_LEAVE();
+	} else {
+		node = list_pushback(cgroup->crlist, cr);
+		
+		if (!node) {
+			free(cr);
+			return -1;
+		}
 	}
 	
 	cgroup->fibers++;
-
+	
 	return 0;
 }
 
@@ -69,38 +313,84 @@ int32_t ucx_cr_add(struct cgroup_s *cgroup, void *(corotine)(void *), uint8_t pr
 static struct node_s *cr_trycancel(struct node_s *node, void *arg)
 {
 	struct ccb_s *cr = node->data;
-	struct ccb_s *crcmp = (struct ccb_s *)arg;
 	
-	if (cr->corotine == crcmp->corotine)
-		return node->data;
+	if (cr->corotine == arg)
+		return node;
+	
+	return 0;
+}
+
+static struct node_s *cr_ccbcmp(struct node_s *node, void *arg)
+{
+	if (node->data == arg)
+		return node;
 	
 	return 0;
 }
 
 int32_t ucx_cr_cancel(struct cgroup_s *cgroup, void *(corotine)(void *))
 {
-	struct node_s *node;
-	struct ccb_s *cr;
+	struct node_s *node = 0;
+	struct ccb_s *cr = 0;
+	int i;
 	
-	node = list_foreach(cgroup->crlist, cr_trycancel, corotine);
+	if (cgroup->crs) {
+		for (i = 0; i < cgroup->max; i++) {
+			if (cgroup->crs[i].corotine == corotine) {
+				cr = &cgroup->crs[i];
+				break;
+			}
+		}
+	} else {
+		node = list_foreach(cgroup->crlist, cr_trycancel, corotine);
+		
+		if (node)
+			cr = node->data;
+	}
 	
-	if (node) {
-		cr = node->data;
-		free(cr);
+	if (!cr)
+		return 0;
+	
+	CRITICAL_ENTER();
+	if (cr->await.obj)
+		krnl_await_unlink(cr);
+	
+	if (cgroup->crs && cr->queued)
+		cr_unlink(cgroup, cr);
+	CRITICAL_LEAVE();
+	
+	if (cr->sleeping)
+		list_remove(cgroup->sleepers, list_foreach(cgroup->sleepers, cr_ccbcmp, cr));
+	
+	if (cgroup->crs) {
+		if (cr->local)
+			free(cr->local);
+		cr->corotine = 0;
+	} else {
 		list_remove(cgroup->crlist, node);
+		free(cr);
 	}
+	cgroup->fibers--;
 	
-	return node ? 1 : 0;
+	return 1;
 }
 
 /* schedule a group of corotines */
 static struct node_s *cr_trysched(struct node_s *node, void *arg)
 {
 	struct ccb_s *cr = node->data;
+	struct cgroup_s *cgroup = ((void **)arg)[0];
+	
+	/* corotines waiting on an object or sleeping are skipped */
+	if (cr->await.obj || cr->sleeping)
+		return 0;
 	
 	if (!--cr->pcounter) {
 		cr->pcounter = cr->priority;
-		cr->corotine(arg);
+		cr->runs++;
+		cgroup->current = cr;
+		cr->corotine(((void **)arg)[1]);
+		cgroup->current = 0;
 		
 		return node;
 	}
@@ -108,11 +398,201 @@ static struct node_s *cr_trysched(struct node_s *node, void *arg)
 	return 0;
 }
 
+/*
+ * array groups: the first corotine of the highest priority class is removed
+ * from its run queue and executed. it is put back at the end of the queue
+ * afterwards, unless it is waiting on an object or it was canceled.
+ */
+static struct ccb_s *cr_schedule_array(struct cgroup_s *cgroup, void *arg)
+{
+	struct ccb_s *cr;
+	
+	CRITICAL_ENTER();
+	cr = cr_dequeue(cgroup);
+	cgroup->current = cr;
+	CRITICAL_LEAVE();
+	
+	if (!cr)
+		return 0;
+	
+	cr->runs++;
+	cr->corotine(arg);
+	
+	CRITICAL_ENTER();
+	cgroup->current = 0;
+	if (cr->corotine && !cr->await.obj && !cr->sleeping && !cr->queued)
+		cr_enqueue(cgroup, cr);
+	CRITICAL_LEAVE();
+	
+	return cr;
+}
+
+/* schedules a single corotine, returning its control block (or 0 if none) */
+static struct ccb_s *cr_schedule(struct cgroup_s *cgroup, void *arg)
+{
+	struct node_s *node;
+	void *args[2] = {cgroup, arg};
+	
+	cr_wakeup(cgroup);
+	
+	if (cgroup->crs)
+		return cr_schedule_array(cgroup, arg);
+	
+	node = list_foreach(cgroup->crlist, cr_trysched, args);
+	
+	return node ? node->data : 0;
+}
+
 int32_t ucx_cr_schedule(struct cgroup_s *cgroup, void *arg)
+{
+	return cr_schedule(cgroup, arg) ? 1 : 0;
+}
+
+static struct node_s *cr_runnable(struct node_s *node, void *arg)
+{
+	struct ccb_s *cr = node->data;
+	
+	if (!cr->await.obj && !cr->sleeping)
+		return node;
+	
+	return 0;
+}
+
+/*
+ * runs corotines of a group in a batch, until a time budget (in microseconds)
+ * expires or no corotine is runnable (a budget of 0 runs a single pass, at
+ * most one invocation per corotine in the group, so it returns even if some
+ * corotine is always runnable). the execution time of each corotine is accumulated in its
+ * control block, in cycle counter units (converted to microseconds only by
+ * ucx_cr_stats()). returns the number of corotines executed.
+ */
+int32_t ucx_cr_run(struct cgroup_s *cgroup, void *arg, uint32_t budget)
+{
+	struct ccb_s *cr;
+	uint64_t start, t0, t1;
+	int32_t n = 0;
+	
+	start = _read_cycles();
+	t0 = start;
+	
+	while (1) {
+		cr = cr_schedule(cgroup, arg);
+		
+		if (cr) {
+			t1 = _read_cycles();
+			cr->time += t1 - t0;
+			t0 = t1;
+			n++;
+		} else {
+			/* list groups: a round may end without a corotine being due */
+			if (cgroup->crs || !list_foreach(cgroup->crlist, cr_runnable, 0))
+				break;
+			t0 = _read_cycles();
+		}
+		
+		if (budget ? ucx_cycles_to_us(t0 - start) >= budget : n >= cgroup->fibers)
+			break;
+	}
+	
+	return n;
+}
+
+/* returns the number of invocations and the accumulated execution time of a corotine */
+int32_t ucx_cr_stats(struct cgroup_s *cgroup, void *(corotine)(void *), uint32_t *runs, uint32_t *time)
 {
 	struct node_s *node;
+	struct ccb_s *cr = 0;
+	int i;
+	
+	if (cgroup->crs) {
+		for (i = 0; i < cgroup->max; i++) {
+			if (cgroup->crs[i].corotine == corotine) {
+				cr = &cgroup->crs[i];
+				break;
+			}
+		}
+	} else {
+		node = list_foreach(cgroup->crlist, cr_trycancel, corotine);
+		
+		if (node)
+			cr = node->data;
+	}
+	
+	if (!cr)
+		return ERR_FAIL;
+	
+	*runs = cr->runs;
+	*time = ucx_cycles_to_us(cr->time);
+	
+	return ERR_OK;
+}
+
+/*
+ * called by a running corotine to wait on a pipe, message queue or semaphore
+ * (using select events). if the object is not ready, 1 is returned and the
+ * corotine should return: it will not be scheduled again until the object
+ * becomes ready. otherwise 0 is returned and the corotine may proceed.
+ */
+int32_t ucx_cr_await(struct cgroup_s *cgroup, void *obj, uint8_t event)
+{
+	int32_t status;
+	
+	if (!cgroup->current)
+		return ERR_FAIL;
+	
+	CRITICAL_ENTER();
+	status = krnl_await(cgroup->current, obj, event);
+	CRITICAL_LEAVE();
+	
+	return status;
+}
+
+/*
+ * called by a running corotine to sleep for a number of milliseconds. the
+ * corotine should return, and it will not be scheduled again until the wake
+ * up time is reached.
+ */
+int32_t ucx_cr_sleep(struct cgroup_s *cgroup, uint32_t ms)
+{
+	struct ccb_s *cr = cgroup->current, *sleeper;
+	struct node_s *node;
+	
+	if (!cr || cr->sleeping)
+		return ERR_FAIL;
+	
+	cr->wake = (uint32_t)ucx_uptime() + ms;
+	node = cgroup->sleepers->head;
+	
+	while (node->next->next) {
+		sleeper = node->next->data;
+		if ((int32_t)(sleeper->wake - cr->wake) > 0)
+			break;
+		node = node->next;
+	}
+	
+	if (!list_insert(cgroup->sleepers, node, cr))
+		return ERR_FAIL;
+	
+	cr->sleeping = 1;
+	
+	return ERR_OK;
+}
+
+/*
+ * returns the time (in ms) until the next sleeping corotine of a group wakes
+ * up (0 if it is already due), or -1 if no corotine is sleeping. a task that
+ * hosts a group may use it to sleep while no corotine is runnable.
+ */
+int32_t ucx_cr_next_wake(struct cgroup_s *cgroup)
+{
+	struct ccb_s *cr;
+	int32_t diff;
+	
+	if (!cgroup->sleepers->length)
+		return -1;
 	
-	node = list_foreach(cgroup->crlist, cr_trysched, arg);
+	cr = cgroup->sleepers->head->next->data;
+	diff = (int32_t)(cr->wake - (uint32_t)ucx_uptime());
 	
-	return node ? 1 : 0;
+	return diff > 0 ? diff : 0;
 }
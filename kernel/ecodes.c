@@ -19,6 +19,7 @@ static struct ecode_s edatadesc[] = {
 	{ERR_SEM_DEALLOC,		"sema dealloc failed"},
 	{ERR_SEM_OPERATION,		"sema operation failed"},
 	{ERR_MQ_NOTEMPTY,		"message queue not empty"},
+	{ERR_TIMEOUT,			"operation timed out"},
 	{ERR_UNKNOWN,			"unknown reason"}
 #endif
 };
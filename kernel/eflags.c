@@ -0,0 +1,144 @@
+/* file:          eflags.c
+ * description:   event flag groups
+ * date:          10/2026
+ */
+
+#include <ucx.h>
+
+/* wait request, kept in the waiting task stack and referenced by its TCB */
+struct eflags_req_s {
+	uint32_t mask;
+	uint32_t flags;
+	uint8_t options;
+};
+
+static int32_t eflags_match(uint32_t flags, uint32_t mask, uint8_t options)
+{
+	if (options & EFLAGS_ALL)
+		return (flags & mask) == mask;
+	else
+		return (flags & mask) != 0;
+}
+
+struct eflags_s *ucx_eflags_create(uint32_t flags)
+{
+	struct eflags_s *ef;
+	
+	ef = malloc(sizeof(struct eflags_s));
+	
+	if (!ef)
+		return 0;
+	
+	ef->wait = krnl_wlist_create();
+	
+	if (!ef->wait) {
+		free(ef);
+		return 0;
+	}
+	
+	ef->flags = flags;
+	
+	return ef;
+}
+
+int32_t ucx_eflags_destroy(struct eflags_s *ef)
+{
+	CRITICAL_ENTER();
+	if (krnl_wlist_destroy(ef->wait)) {
+		CRITICAL_LEAVE();
+		
+		return -1;
+	}
+	
+	free(ef);
+	CRITICAL_LEAVE();
+	
+	return 0;
+}
+
+/*
+ * sets flags and releases all waiters with a matching condition in a single
+ * pass. each released waiter is unlinked from the wait list in constant time
+ * (the next waiter is kept before the release), and no heap operations are
+ * performed, so it can be called from interrupt handlers. flags requested to
+ * be cleared on exit are cleared after the pass, so all waiters see the same
+ * flags.
+ */
+uint32_t ucx_eflags_set(struct eflags_s *ef, uint32_t mask)
+{
+	struct tcb_s *task, *next;
+	struct eflags_req_s *req;
+	uint32_t clear = 0, flags;
+	
+	CRITICAL_ENTER();
+	ef->flags |= mask;
+	task = ef->wait->head;
+	
+	while (task) {
+		next = task->wnext;
+		req = task->wdata;
+		
+		if (eflags_match(ef->flags, req->mask, req->options)) {
+			req->flags = ef->flags;
+			if (req->options & EFLAGS_CLEAR)
+				clear |= req->mask;
+			krnl_release(task);
+		}
+		task = next;
+	}
+	
+	ef->flags &= ~clear;
+	flags = ef->flags;
+	CRITICAL_LEAVE();
+	
+	return flags;
+}
+
+uint32_t ucx_eflags_clear(struct eflags_s *ef, uint32_t mask)
+{
+	uint32_t flags;
+	
+	CRITICAL_ENTER();
+	ef->flags &= ~mask;
+	flags = ef->flags;
+	CRITICAL_LEAVE();
+	
+	return flags;
+}
+
+uint32_t ucx_eflags_get(struct eflags_s *ef)
+{
+	return ef->flags;
+}
+
+/*
+ * waits for any (EFLAGS_ANY) or all (EFLAGS_ALL) flags in the mask, with a
+ * timeout in ticks (WAIT_FOREVER or 0 to not block). EFLAGS_CLEAR clears the
+ * mask flags on exit. the flags that satisfied the condition are returned in
+ * 'flags' (if not null).
+ */
+int32_t ucx_eflags_wait(struct eflags_s *ef, uint32_t mask, uint8_t options, uint32_t *flags, uint16_t timeout)
+{
+	struct eflags_req_s req;
+	int32_t status = ERR_OK;
+	
+	if (!mask)
+		return ERR_FAIL;
+	
+	CRITICAL_ENTER();
+	if (eflags_match(ef->flags, mask, options)) {
+		req.flags = ef->flags;
+		if (options & EFLAGS_CLEAR)
+			ef->flags &= ~mask;
+	} else {
+		req.mask = mask;
+		req.options = options;
+		status = krnl_block(ef->wait, &req, timeout);
+	}
+	CRITICAL_LEAVE();
+	
+	if (!status && flags)
+		*flags = req.flags;
+	
+	return status;
+}
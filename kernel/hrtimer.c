@@ -0,0 +1,175 @@
+/* file:          hrtimer.c
+ * description:   high resolution one-shot timers
+ * date:          10/2026
+ */
+
+#include <ucx.h>
+
+
+/*
+ * high resolution timers are one-shot timers with microsecond resolution,
+ * backed by a hardware compare register programmed by the HAL. they are not
+ * bound to the system tick: each timer holds an absolute deadline (in the
+ * time base of _read_us()) and active timers are kept in a list sorted by
+ * deadline. only the first deadline is programmed in hardware, with
+ * _hrtimer_set(). when it expires, the HAL calls krnl_hrtimer_handler() from
+ * its interrupt handler, which runs the callbacks of all expired timers and
+ * programs the next deadline.
+ *
+ * callbacks run in interrupt context. they should be short and must not
+ * block (i.e. notify or signal a task and return). a callback may start
+ * its own timer again. timers are started and canceled with interrupts
+ * disabled, so these calls must not be used inside a critical section.
+ */
+
+static struct hrtimer_s *hrtimer_lst;
+static volatile uint8_t hrtimer_isr;
+
+static void hrtimer_lock(void)
+{
+	if (!hrtimer_isr)
+		_di();
+}
+
+static void hrtimer_unlock(void)
+{
+	if (!hrtimer_isr)
+		_ei();
+}
+
+static void hrtimer_unlink(struct hrtimer_s *hr)
+{
+	struct hrtimer_s **p;
+	
+	for (p = &hrtimer_lst; *p; p = &(*p)->next) {
+		if (*p == hr) {
+			*p = hr->next;
+			break;
+		}
+	}
+	hr->next = 0;
+	hr->active = 0;
+}
+
+/* program the hardware when the first deadline changes (not needed inside the handler) */
+static int32_t hrtimer_reprogram(struct hrtimer_s *head, uint64_t deadline)
+{
+	if (hrtimer_isr || (hrtimer_lst == head && (!head || head->deadline == deadline)))
+		return ERR_OK;
+	
+	return _hrtimer_set(hrtimer_lst ? hrtimer_lst->deadline : 0);
+}
+
+struct hrtimer_s *ucx_hrtimer_create(void *(*hrtimer_cb)(void *arg), void *arg)
+{
+	struct hrtimer_s *hr;
+	
+	if (!hrtimer_cb)
+		return 0;
+	
+	hr = malloc(sizeof(struct hrtimer_s));
+	if (!hr)
+		return 0;
+	
+	hr->next = 0;
+	hr->hrtimer_cb = hrtimer_cb;
+	hr->arg = arg;
+	hr->deadline = 0;
+	hr->active = 0;
+	
+	return hr;
+}
+
+int32_t ucx_hrtimer_destroy(struct hrtimer_s *hr)
+{
+	if (!hr)
+		return ERR_FAIL;
+	
+	ucx_hrtimer_cancel(hr);
+	free(hr);
+	
+	return ERR_OK;
+}
+
+/*
+ * starts (or restarts) a timer, to expire in 'usec' microseconds
+ * - remove the timer from the active list, if already started
+ * - insert it sorted by deadline (FIFO among equal deadlines)
+ * - if the first deadline changed, program the hardware
+ */
+int32_t ucx_hrtimer_start(struct hrtimer_s *hr, uint32_t usec)
+{
+	struct hrtimer_s *head, **p;
+	uint64_t deadline;
+	
+	if (!hr)
+		return ERR_FAIL;
+	
+	hrtimer_lock();
+	head = hrtimer_lst;
+	deadline = head ? head->deadline : 0;
+	if (hr->active)
+		hrtimer_unlink(hr);
+	
+	hr->deadline = _read_us() + usec;
+	for (p = &hrtimer_lst; *p && (*p)->deadline <= hr->deadline; p = &(*p)->next);
+	hr->next = *p;
+	*p = hr;
+	hr->active = 1;
+	
+	if (hrtimer_reprogram(head, deadline) < 0) {
+		hrtimer_unlink(hr);
+		hrtimer_unlock();
+		
+		return ERR_FAIL;
+	}
+	hrtimer_unlock();
+	
+	return ERR_OK;
+}
+
+int32_t ucx_hrtimer_cancel(struct hrtimer_s *hr)
+{
+	struct hrtimer_s *head;
+	
+	if (!hr)
+		return ERR_FAIL;
+	
+	hrtimer_lock();
+	if (!hr->active) {
+		hrtimer_unlock();
+		
+		return ERR_FAIL;
+	}
+	head = hrtimer_lst;
+	hrtimer_unlink(hr);
+	hrtimer_reprogram(head, head->deadline);
+	hrtimer_unlock();
+	
+	return ERR_OK;
+}
+
+/*
+ * called by the HAL (interrupt context) when the programmed deadline expires
+ * - remove and run every timer whose deadline has passed
+ * - program the next deadline (or disable the hardware timer)
+ */
+void krnl_hrtimer_handler(void)
+{
+	struct hrtimer_s *hr;
+	uint64_t now;
+	
+	hrtimer_isr = 1;
+	now = _read_us();
+	
+	while (hrtimer_lst && hrtimer_lst->deadline <= now) {
+		hr = hrtimer_lst;
+		hrtimer_lst = hr->next;
+		hr->next = 0;
+		hr->active = 0;
+		hr->hrtimer_cb(hr->arg);
+	}
+	
+	_hrtimer_set(hrtimer_lst ? hrtimer_lst->deadline : 0);
+	hrtimer_isr = 0;
+}
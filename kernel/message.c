@@ -22,15 +22,39 @@ struct mq_s *ucx_mq_create(uint16_t size)
 		return 0;
 	}
 	
+	mqptr->rwait = krnl_wlist_create();
+	
+	if (!mqptr->rwait) {
+		queue_destroy(mqptr->queue);
+		free(mqptr);
+		return 0;
+	}
+	
+	mqptr->swait = krnl_wlist_create();
+	
+	if (!mqptr->swait) {
+		krnl_wlist_destroy(mqptr->rwait);
+		queue_destroy(mqptr->queue);
+		free(mqptr);
+		return 0;
+	}
+	
+	mqptr->pool = 0;
+	
 	return mqptr;
 }
 
 int32_t ucx_mq_destroy(struct mq_s *mq)
 {
-	if (queue_count(mq->queue))
+	CRITICAL_ENTER();
+	if (queue_count(mq->queue) || mq->rwait->length || mq->swait->length) {
+		CRITICAL_LEAVE();
+		
 		return ERR_MQ_NOTEMPTY;
+	}
 	
-	CRITICAL_ENTER();
+	krnl_wlist_destroy(mq->swait);
+	krnl_wlist_destroy(mq->rwait);
 	queue_destroy(mq->queue);
 	free(mq);
 	CRITICAL_LEAVE();
@@ -38,12 +62,63 @@ int32_t ucx_mq_destroy(struct mq_s *mq)
 	return 0;
 }
 
+/*
+ * Messages are handed over directly to blocked tasks. If a receiver is waiting
+ * the queue is empty, so a new message is passed to the highest priority
+ * receiver. If a sender is waiting the queue is full, so when a message is
+ * removed the message of the highest priority sender takes its place. These
+ * must be called inside a critical section.
+ */
+static int32_t mq_put(struct mq_s *mq, struct message_s *m)
+{
+	struct tcb_s *task;
+	
+	task = krnl_unblock(mq->rwait);
+	
+	if (task) {
+		task->wdata = m;
+		
+		return 0;
+	}
+	
+	if (queue_enqueue(mq->queue, m))
+		return -1;
+	
+	krnl_select_notify(mq);
+	
+	return 0;
+}
+
+static int32_t mq_get(struct mq_s *mq, struct message_s **m)
+{
+	struct tcb_s *task;
+	
+	if (!queue_count(mq->queue))
+		return -1;
+	
+	*m = queue_dequeue(mq->queue);
+	task = krnl_unblock(mq->swait);
+	
+	if (task)
+		queue_enqueue(mq->queue, task->wdata);
+	else
+		krnl_select_notify(mq);
+	
+	return 0;
+}
+
+/* must be called inside a critical section */
+int32_t krnl_mq_enqueue(struct mq_s *mq, struct message_s *m)
+{
+	return mq_put(mq, m);
+}
+
 int32_t ucx_mq_enqueue(struct mq_s *mq, struct message_s *m)
 {
 	int32_t status;
 	
 	CRITICAL_ENTER();
-	status = queue_enqueue(mq->queue, m);
+	status = mq_put(mq, m);
 	CRITICAL_LEAVE();
 	
 	return status;
@@ -54,12 +129,49 @@ struct message_s *ucx_mq_dequeue(struct mq_s *mq)
 	struct message_s *m;
 	
 	CRITICAL_ENTER();
-	m = queue_dequeue(mq->queue);
+	if (mq_get(mq, &m))
+		m = 0;
 	CRITICAL_LEAVE();
 	
 	return m;
 }
 
+/* blocking calls, with a timeout in ticks (WAIT_FOREVER or 0 to not block) */
+int32_t ucx_mq_send(struct mq_s *mq, struct message_s *m, uint16_t timeout)
+{
+	int32_t status;
+	
+	CRITICAL_ENTER();
+	status = mq_put(mq, m);
+	
+	if (status)
+		status = krnl_block(mq->swait, m, timeout);
+	CRITICAL_LEAVE();
+	
+	return status;
+}
+
+int32_t ucx_mq_recv(struct mq_s *mq, struct message_s **m, uint16_t timeout)
+{
+	struct tcb_s *task;
+	int32_t status;
+	
+	CRITICAL_ENTER();
+	status = mq_get(mq, m);
+	
+	if (status) {
+		status = krnl_block(mq->rwait, 0, timeout);
+		
+		if (!status) {
+			task = kcb->task_current->data;
+			*m = task->wdata;
+		}
+	}
+	CRITICAL_LEAVE();
+	
+	return status;
+}
+
 struct message_s *ucx_mq_peek(struct mq_s *mq)
 {
 	struct message_s *m;
@@ -79,3 +191,168 @@ int32_t ucx_mq_items(struct mq_s *mq)
 	
 	return mcount;
 }
+
+/*
+ * Message pool integration. A memory pool is attached to a queue (pools may be
+ * shared by several queues) and messages are allocated from it. Each block
+ * holds a message header, followed by its payload (the remaining block space),
+ * so neither messages nor their data are allocated from the heap.
+ */
+int32_t ucx_mq_pool(struct mq_s *mq, struct mpool_s *pool)
+{
+	if (pool && pool->bsize < sizeof(struct message_s))
+		return -1;
+	
+	mq->pool = pool;
+	
+	return 0;
+}
+
+struct message_s *ucx_mq_alloc(struct mq_s *mq)
+{
+	struct message_s *m;
+	
+	if (!mq->pool)
+		return 0;
+	
+	m = ucx_mpool_alloc(mq->pool);
+	
+	if (m) {
+		m->data = m + 1;
+		m->type = 0;
+		m->size = mq->pool->bsize - sizeof(struct message_s);
+	}
+	
+	return m;
+}
+
+int32_t ucx_mq_free(struct mq_s *mq, struct message_s *m)
+{
+	if (!mq->pool)
+		return -1;
+	
+	return ucx_mpool_free(mq->pool, m);
+}
+
+
+/*
+ * Priority message queues. Messages are kept in a FIFO queue per priority
+ * band and a bitmap tracks non-empty bands, so the highest priority message
+ * is found in constant time. Band 0 has the highest priority.
+ */
+struct pmq_s *ucx_pmq_create(uint16_t size, uint8_t bands)
+{
+	struct pmq_s *pmq;
+	int i;
+	
+	if (!bands || bands > PMQ_MAX_BANDS)
+		return 0;
+	
+	pmq = malloc(sizeof(struct pmq_s));
+	
+	if (!pmq)
+		return 0;
+	
+	pmq->band = malloc(bands * sizeof(struct queue_s *));
+	
+	if (!pmq->band) {
+		free(pmq);
+		return 0;
+	}
+	
+	for (i = 0; i < bands; i++) {
+		pmq->band[i] = queue_create(size);
+		
+		if (!pmq->band[i]) {
+			while (--i >= 0)
+				queue_destroy(pmq->band[i]);
+			free(pmq->band);
+			free(pmq);
+			return 0;
+		}
+	}
+	
+	pmq->bitmap = 0;
+	pmq->bands = bands;
+	
+	return pmq;
+}
+
+int32_t ucx_pmq_destroy(struct pmq_s *pmq)
+{
+	int i;
+	
+	if (pmq->bitmap)
+		return ERR_MQ_NOTEMPTY;
+	
+	CRITICAL_ENTER();
+	for (i = 0; i < pmq->bands; i++)
+		queue_destroy(pmq->band[i]);
+	free(pmq->band);
+	free(pmq);
+	CRITICAL_LEAVE();
+	
+	return 0;
+}
+
+int32_t ucx_pmq_enqueue(struct pmq_s *pmq, struct message_s *m, uint8_t band)
+{
+	int32_t status;
+	
+	if (band >= pmq->bands)
+		return -1;
+	
+	CRITICAL_ENTER();
+	status = queue_enqueue(pmq->band[band], m);
+	if (!status)
+		pmq->bitmap |= (1UL << band);
+	CRITICAL_LEAVE();
+	
+	return status;
+}
+
+struct message_s *ucx_pmq_dequeue(struct pmq_s *pmq)
+{
+	struct message_s *m = 0;
+	int32_t band;
+	
+	CRITICAL_ENTER();
+	band = ucx_ffs(pmq->bitmap) - 1;
+	if (band >= 0) {
+		m = queue_dequeue(pmq->band[band]);
+		if (!queue_count(pmq->band[band]))
+			pmq->bitmap &= ~(1UL << band);
+	}
+	CRITICAL_LEAVE();
+	
+	return m;
+}
+
+struct message_s *ucx_pmq_peek(struct pmq_s *pmq, uint8_t band)
+{
+	struct message_s *m = 0;
+	int32_t b = band;
+	
+	CRITICAL_ENTER();
+	if (band == PMQ_BAND_ANY)
+		b = ucx_ffs(pmq->bitmap) - 1;
+	if (b >= 0 && b < pmq->bands)
+		m = queue_peek(pmq->band[b]);
+	CRITICAL_LEAVE();
+	
+	return m;
+}
+
+int32_t ucx_pmq_items(struct pmq_s *pmq, uint8_t band)
+{
+	int32_t mcount = 0;
+	int i;
+	
+	if (band != PMQ_BAND_ANY)
+		return band < pmq->bands ? queue_count(pmq->band[band]) : 0;
+	
+	for (i = 0; i < pmq->bands; i++)
+		mcount += queue_count(pmq->band[i]);
+	
+	return mcount;
+}
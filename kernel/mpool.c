@@ -0,0 +1,126 @@
+/* file:          mpool.c
+ * description:   fixed size block memory pool
+ * date:          10/2026
+ */
+
+#include <ucx.h>
+
+/*
+ * A memory pool is allocated from the heap once, on creation, and split into
+ * blocks of the same size. Free blocks are kept in a singly linked list, so
+ * both allocation and release of a block are constant time operations. These
+ * can be used from interrupt handlers, as no heap operations are performed.
+ */
+struct mpool_s *ucx_mpool_create(uint16_t bsize, uint16_t blocks)
+{
+	struct mpool_s *mp;
+	char *block;
+	int i;
+	
+	if (!blocks)
+		return 0;
+	
+	if (bsize < sizeof(void *))
+		bsize = sizeof(void *);
+	bsize = (bsize + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+	
+	mp = malloc(sizeof(struct mpool_s));
+	
+	if (!mp)
+		return 0;
+	
+	mp->pool = malloc((uint32_t)bsize * blocks);
+	
+	if (!mp->pool) {
+		free(mp);
+		return 0;
+	}
+	
+	block = mp->pool;
+	for (i = 0; i < blocks - 1; i++) {
+		*(void **)block = block + bsize;
+		block += bsize;
+	}
+	*(void **)block = 0;
+	
+	mp->free = mp->pool;
+	mp->bsize = bsize;
+	mp->blocks = blocks;
+	mp->avail = blocks;
+	
+	return mp;
+}
+
+int32_t ucx_mpool_destroy(struct mpool_s *mp)
+{
+	if (mp->avail != mp->blocks)
+		return -1;
+	
+	free(mp->pool);
+	free(mp);
+	
+	return 0;
+}
+
+void *ucx_mpool_alloc(struct mpool_s *mp)
+{
+	void *block;
+	
+	CRITICAL_ENTER();
+	block = mp->free;
+	if (block) {
+		mp->free = *(void **)block;
+		mp->avail--;
+	}
+	CRITICAL_LEAVE();
+	
+	return block;
+}
+
+/*
+ * returns a block to the pool. pointers out of the pool area, or not at the
+ * start of a block, are rejected. if built with MPOOL_CHECK, the free list is
+ * also searched for the block, so double frees are rejected (this takes time
+ * proportional to the number of free blocks, with interrupts disabled).
+ */
+int32_t ucx_mpool_free(struct mpool_s *mp, void *block)
+{
+	char *start = mp->pool;
+	char *end = start + (uint32_t)mp->bsize * mp->blocks;
+#ifdef MPOOL_CHECK
+	void *free;
+#endif
+	
+	if ((char *)block < start || (char *)block >= end)
+		return -1;
+	
+	if (((char *)block - start) % mp->bsize)
+		return -1;
+	
+	CRITICAL_ENTER();
+	if (mp->avail == mp->blocks) {
+		CRITICAL_LEAVE();
+		
+		return -1;
+	}
+#ifdef MPOOL_CHECK
+	for (free = mp->free; free; free = *(void **)free) {
+		if (free == block) {
+			CRITICAL_LEAVE();
+			
+			return -1;
+		}
+	}
+#endif
+	*(void **)block = mp->free;
+	mp->free = block;
+	mp->avail++;
+	CRITICAL_LEAVE();
+	
+	return 0;
+}
+
+int32_t ucx_mpool_avail(struct mpool_s *mp)
+{
+	return mp->avail;
+}
@@ -66,10 +66,15 @@ int32_t ucx_pipe_destroy(struct pipe_s *pipe)
 
 void ucx_pipe_flush(struct pipe_s *pipe)
 {
+	int32_t full;
+	
 	CRITICAL_ENTER();
+	full = pipe->size == (int32_t)pipe->mask;
 	pipe->head = 0;
 	pipe->tail = 0;
 	pipe->size = 0;
+	if (full)
+		krnl_select_notify(pipe);
 	CRITICAL_LEAVE();
 }
 
@@ -88,7 +93,10 @@ static int32_t ucx_pipe_get(struct pipe_s *pipe)
 	head = pipe->head;
 	pipe->head = (pipe->head + 1) & pipe->mask;
 	data = pipe->data[head];
-	pipe->size--;
+	
+	/* selectors are notified only when the pipe is no longer full */
+	if (pipe->size-- == (int32_t)pipe->mask)
+		krnl_select_notify(pipe);
 
 	return data;
 }
@@ -103,7 +111,10 @@ static int32_t ucx_pipe_put(struct pipe_s *pipe, char data)
 		
 	pipe->data[pipe->tail] = data;
 	pipe->tail = tail;
-	pipe->size++;
+	
+	/* selectors are notified only when the pipe is no longer empty */
+	if (pipe->size++ == 0)
+		krnl_select_notify(pipe);
 
 	return 0;
 }
@@ -0,0 +1,138 @@
+/* file:          rwlock.c
+ * description:   reader-writer lock (writer preference)
+ * date:          10/2026
+ */
+
+#include <ucx.h>
+
+/*
+ * Several readers may hold the lock at the same time, while a writer holds it
+ * exclusively. New readers are not admitted while a writer is waiting, so
+ * writers are not starved by a continuous flow of readers. Blocked tasks are
+ * kept in kernel wait lists, and the lock is handed over to released tasks
+ * (they are accounted as holders before they resume execution).
+ */
+
+/* must be called inside a critical section */
+static void rwlock_release(struct rwlock_s *rw)
+{
+	if (rw->writer || rw->readers)
+		return;
+	
+	if (rw->wwait->length) {
+		rw->writer = 1;
+		krnl_unblock(rw->wwait);
+	} else {
+		while (krnl_unblock(rw->rwait))
+			rw->readers++;
+	}
+}
+
+struct rwlock_s *ucx_rwlock_create(void)
+{
+	struct rwlock_s *rw;
+	
+	rw = malloc(sizeof(struct rwlock_s));
+	
+	if (!rw)
+		return 0;
+	
+	rw->rwait = krnl_wlist_create();
+	
+	if (!rw->rwait) {
+		free(rw);
+		return 0;
+	}
+	
+	rw->wwait = krnl_wlist_create();
+	
+	if (!rw->wwait) {
+		krnl_wlist_destroy(rw->rwait);
+		free(rw);
+		return 0;
+	}
+	
+	rw->readers = 0;
+	rw->writer = 0;
+	
+	return rw;
+}
+
+int32_t ucx_rwlock_destroy(struct rwlock_s *rw)
+{
+	CRITICAL_ENTER();
+	if (rw->readers || rw->writer || rw->rwait->length || rw->wwait->length) {
+		CRITICAL_LEAVE();
+		
+		return -1;
+	}
+	
+	krnl_wlist_destroy(rw->wwait);
+	krnl_wlist_destroy(rw->rwait);
+	free(rw);
+	CRITICAL_LEAVE();
+	
+	return 0;
+}
+
+/* lock operations, with a timeout in ticks (WAIT_FOREVER or 0 to not block) */
+int32_t ucx_rwlock_rdlock(struct rwlock_s *rw, uint16_t timeout)
+{
+	int32_t status = ERR_OK;
+	
+	CRITICAL_ENTER();
+	if (!rw->writer && !rw->wwait->length)
+		rw->readers++;
+	else
+		status = krnl_block(rw->rwait, 0, timeout);
+	CRITICAL_LEAVE();
+	
+	return status;
+}
+
+int32_t ucx_rwlock_wrlock(struct rwlock_s *rw, uint16_t timeout)
+{
+	int32_t status = ERR_OK;
+	
+	CRITICAL_ENTER();
+	if (!rw->writer && !rw->readers) {
+		rw->writer = 1;
+	} else {
+		status = krnl_block(rw->wwait, 0, timeout);
+		
+		/*
+		 * readers may have been held back only by this writer. if no
+		 * writer is left, they are admitted along with current readers.
+		 */
+		if (status) {
+			if (!rw->writer && !rw->wwait->length) {
+				while (krnl_unblock(rw->rwait))
+					rw->readers++;
+			} else {
+				rwlock_release(rw);
+			}
+		}
+	}
+	CRITICAL_LEAVE();
+	
+	return status;
+}
+
+int32_t ucx_rwlock_unlock(struct rwlock_s *rw)
+{
+	CRITICAL_ENTER();
+	if (rw->writer) {
+		rw->writer = 0;
+	} else if (rw->readers) {
+		rw->readers--;
+	} else {
+		CRITICAL_LEAVE();
+		
+		return -1;
+	}
+	
+	rwlock_release(rw);
+	CRITICAL_LEAVE();
+	
+	return 0;
+}
@@ -0,0 +1,181 @@
+/* file:          select.c
+ * description:   wait on multiple pipes, message queues and semaphores
+ * date:          10/2026
+ */
+
+#include <ucx.h>
+
+/* select request, kept in the waiting task stack and referenced by its TCB */
+struct select_req_s {
+	struct select_s *sel;
+	uint16_t left;				/* ticks left when released */
+	uint8_t n;
+};
+
+static int32_t select_ready(struct select_s *sel)
+{
+	struct pipe_s *pipe;
+	struct mq_s *mq;
+	struct sem_s *s;
+	
+	switch (sel->event) {
+	case SELECT_PIPE_READ:
+		pipe = sel->obj;
+		return pipe->size > 0;
+	case SELECT_PIPE_WRITE:
+		pipe = sel->obj;
+		return pipe->size < (int32_t)pipe->mask;
+	case SELECT_MQ_READ:
+		mq = sel->obj;
+		return queue_count(mq->queue) > 0;
+	case SELECT_MQ_WRITE:
+		mq = sel->obj;
+		return queue_count(mq->queue) < mq->queue->mask;
+	case SELECT_SEM:
+		s = sel->obj;
+		return s->count > 0;
+	default:
+		return 0;
+	}
+}
+
+static uint32_t select_poll(struct select_s *sel, uint8_t n)
+{
+	uint32_t ready = 0;
+	int i;
+	
+	for (i = 0; i < n; i++)
+		if (select_ready(&sel[i]))
+			ready |= (1UL << i);
+	
+	return ready;
+}
+
+/*
+ * called (inside a critical section) by pipes, message queues and semaphores
+ * when they may have become ready. tasks blocked in ucx_select() waiting on
+ * the object are released if any of their events is ready, and coroutines
+ * awaiting the object are made runnable again.
+ */
+static void await_notify(void *obj)
+{
+	struct ccb_s *cr, *next;
+	
+	cr = kcb->await_lst;
+	
+	while (cr) {
+		next = cr->anext;
+		
+		if (cr->await.obj == obj && select_ready(&cr->await)) {
+			krnl_await_unlink(cr);
+			krnl_cr_wakeup(cr);
+		}
+		cr = next;
+	}
+}
+
+/*
+ * removes a coroutine from the await list (inside a critical section). no
+ * heap call is made, as coroutines are linked through their own ccb.
+ */
+void krnl_await_unlink(struct ccb_s *cr)
+{
+	*cr->apprev = cr->anext;
+	if (cr->anext)
+		cr->anext->apprev = cr->apprev;
+	cr->anext = 0;
+	cr->apprev = 0;
+	cr->await.obj = 0;
+}
+
+/*
+ * registers a coroutine interest in an object (inside a critical section). if
+ * the object is not ready, the coroutine is put in the await list and 1 is
+ * returned, otherwise 0 is returned and the coroutine is not registered.
+ */
+int32_t krnl_await(struct ccb_s *cr, void *obj, uint8_t event)
+{
+	cr->await.obj = obj;
+	cr->await.event = event;
+	
+	if (select_ready(&cr->await)) {
+		cr->await.obj = 0;
+		
+		return 0;
+	}
+	
+	cr->anext = kcb->await_lst;
+	cr->apprev = &kcb->await_lst;
+	if (cr->anext)
+		cr->anext->apprev = &cr->anext;
+	kcb->await_lst = cr;
+	
+	return 1;
+}
+
+void krnl_select_notify(void *obj)
+{
+	struct tcb_s *task, *next;
+	struct select_req_s *req;
+	int i;
+	
+	if (kcb->await_lst)
+		await_notify(obj);
+	
+	if (!kcb->select_lst->length)
+		return;
+	
+	task = kcb->select_lst->head;
+	
+	while (task) {
+		next = task->wnext;
+		req = task->wdata;
+		
+		for (i = 0; i < req->n; i++) {
+			if (req->sel[i].obj == obj && select_ready(&req->sel[i])) {
+				req->left = task->delay;
+				krnl_release(task);
+				break;
+			}
+		}
+		task = next;
+	}
+}
+
+/*
+ * waits until at least one of 'n' objects is ready for the requested event,
+ * with a timeout in ticks (WAIT_FOREVER or 0 to not block). the timeout is not
+ * restarted if the task is released but no object is ready. the readiness
+ * mask (bit i set for sel[i]) is returned in 'ready'. objects are not
+ * consumed, so the task must read (or write / trywait) the ready objects
+ * afterwards.
+ */
+int32_t ucx_select(struct select_s *sel, uint8_t n, uint32_t *ready, uint16_t timeout)
+{
+	struct select_req_s req;
+	int32_t status = ERR_OK;
+	uint32_t mask;
+	
+	if (!n || n > SELECT_MAX)
+		return ERR_FAIL;
+	
+	req.sel = sel;
+	req.n = n;
+	
+	CRITICAL_ENTER();
+	while (!(mask = select_poll(sel, n))) {
+		status = krnl_block(kcb->select_lst, &req, timeout);
+		
+		if (status)
+			break;
+		
+		/* released, but nothing ready (yet): wait for the remaining ticks */
+		if (timeout != WAIT_FOREVER)
+			timeout = req.left;
+	}
+	CRITICAL_LEAVE();
+	
+	*ready = mask;
+	
+	return status;
+}
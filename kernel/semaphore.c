@@ -41,11 +41,34 @@ int32_t ucx_sem_destroy(struct sem_s *s)
 	}
 }
 
+/*
+ * Uncontended operations use a fast path, based on a single atomic compare
+ * and swap on the semaphore count. The kernel (critical section) path is used
+ * only when a task has to block (count <= 0) or to be woken up (count < 0).
+ */
+static int32_t sem_tryacquire(struct sem_s *s)
+{
+	int32_t count, prev;
+	
+	count = s->count;
+	while (count > 0) {
+		prev = _atomic_cas(&s->count, count, count - 1);
+		if (prev == count)
+			return 0;
+		count = prev;
+	}
+	
+	return -1;
+}
+
 void ucx_sem_wait(struct sem_s *s)
 {
 	struct tcb_s *tcb_sem;
 	int qs;
 	
+	if (!sem_tryacquire(s))
+		return;
+	
 	CRITICAL_ENTER();
 	s->count--;
 	if (s->count < 0) {
@@ -61,31 +84,98 @@ void ucx_sem_wait(struct sem_s *s)
 	}
 }
 
-int32_t ucx_sem_trywait(struct sem_s *s)
+/*
+ * waits on a semaphore for at most 'ticks' (WAIT_FOREVER or 0 to not block).
+ * the task is queued on the semaphore and also delayed, so it is released by
+ * whichever comes first. if the delay expires first the task is still queued,
+ * and it withdraws itself from the semaphore returning ERR_TIMEOUT.
+ */
+int32_t ucx_sem_timedwait(struct sem_s *s, uint16_t ticks)
 {
-	int val = 0;
+	struct tcb_s *tcb_sem, *tcb;
+	int32_t i, n, status = ERR_OK;
+	
+	if (!sem_tryacquire(s))
+		return ERR_OK;
 	
 	CRITICAL_ENTER();
-	if (s->count <= 0)
-		val = -1;
-	else
+	if (s->count > 0) {
 		s->count--;
+		CRITICAL_LEAVE();
+		
+		return ERR_OK;
+	}
+	
+	if (!ticks) {
+		CRITICAL_LEAVE();
+		
+		return ERR_TIMEOUT;
+	}
+	
+	s->count--;
+	tcb_sem = kcb->task_current->data;
+	if (queue_enqueue(s->sem_queue, tcb_sem))
+		krnl_panic(ERR_SEM_OPERATION);
+	tcb_sem->delay = ticks == WAIT_FOREVER ? 0 : ticks;
+	tcb_sem->state = TASK_BLOCKED;
 	CRITICAL_LEAVE();
+	ucx_task_yield();
 	
-	return val;
+	CRITICAL_ENTER();
+	n = queue_count(s->sem_queue);
+	for (i = 0; i < n; i++) {
+		tcb = queue_dequeue(s->sem_queue);
+		if (tcb == tcb_sem) {
+			s->count++;
+			status = ERR_TIMEOUT;
+		} else {
+			queue_enqueue(s->sem_queue, tcb);
+		}
+	}
+	CRITICAL_LEAVE();
+	
+	return status;
 }
 
-void ucx_sem_signal(struct sem_s *s)
+int32_t ucx_sem_trywait(struct sem_s *s)
+{
+	return sem_tryacquire(s);
+}
+
+/* must be called inside a critical section */
+void krnl_sem_signal(struct sem_s *s)
 {
 	struct tcb_s *tcb_sem;
 	
-	CRITICAL_ENTER();
 	s->count++;
 	if (s->count <= 0) {
 		tcb_sem = queue_dequeue(s->sem_queue);
 		if (tcb_sem == 0)
 			krnl_panic(ERR_SEM_OPERATION);
+		tcb_sem->delay = 0;
 		tcb_sem->state = TASK_READY;
+	} else {
+		krnl_select_notify(s);
+	}
+}
+
+void ucx_sem_signal(struct sem_s *s)
+{
+	int32_t count;
+	
+	/* no waiters, so just increment the count (and notify selectors, if any) */
+	count = s->count;
+	if (count >= 0 && _atomic_cas(&s->count, count, count + 1) == count) {
+		if (kcb->select_lst->length || kcb->await_lst) {
+			CRITICAL_ENTER();
+			krnl_select_notify(s);
+			CRITICAL_LEAVE();
+		}
+		
+		return;
 	}
+	
+	CRITICAL_ENTER();
+	krnl_sem_signal(s);
 	CRITICAL_LEAVE();
 }
@@ -2,58 +2,463 @@
 
 
 /*
- * - iterate the list and for each element:
- * 	* if TIMER_DISABLED, continue
- * 	* countdown--
- * 	* check if countdown == 0
- * 		- if so, call timer callback
- * 		- if TIMER_AUTORELOAD, reset countdown
+ * two implementations: based on systick and based on system uptime
+ * 
+ * systick based timers are kept in a hierarchical timing wheel, built when
+ * timer_handler_systick() is first called. each level has TWHEEL_SIZE slots,
+ * and a slot of level n holds timers expiring in a range of TWHEEL_SIZE^n
+ * ticks. timers are inserted in a slot according to their expiration tick
+ * (relative to the next tick to be processed) and each slot is a doubly linked
+ * list, so timers are started and canceled in constant time. on each tick,
+ * only the current slot of the first level is expired. when the first level
+ * wraps, the next slot of the level above is cascaded (its timers are inserted
+ * again, in lower levels).
+ * 
+ * - for each elapsed tick:
+ * 	* cascade upper levels, if the lower level wrapped
+ * 	* for each timer in the current slot:
+ * 		- call timer callback
+ * 		- if TIMER_AUTORELOAD, insert it again
  * 		- if TIMER_ONESHOT, set TIMER_DISABLED
  * - yield
- * two implementations: based on systick and based on system uptime
+ * 
+ * timers with slack may expire up to 'slack' ticks late. such timers are
+ * inserted at the tick inside their window with most trailing zero bits, so
+ * timers with overlapping windows tend to expire on the same tick.
+ */
+
+/*
+ * timers are kept in a slot table. a timer handle (timer_id) holds the slot
+ * index in its lower TSLOT_BITS and a generation count in the upper bits,
+ * incremented each time the slot is reused, so stale handles are rejected.
+ * free slots are chained (through tslot_s.free), so a slot is claimed or
+ * released in constant time.
  */
+static struct tslot_s *tslot;
+static uint16_t tslot_size, tslot_count;
+static uint16_t tslot_free = TSLOT_NONE;
 
-static struct node_s *timer_update_systick(struct node_s *node, void *arg)
+/*
+ * timer callbacks are called inline by the timer handler, unless the timer
+ * is assigned to a service. in that case, the expired timer is queued to the
+ * service and its callback is called by a service task (see timer_service()),
+ * which may run at a different priority. if a timer expires again before its
+ * callback is called, the expiration is counted as an overrun. in both cases
+ * the callback argument is the expiration time (uptime in ms, or the tick for
+ * systick timers), kept in 64 bits while queued and cast to a pointer.
+ */
+static struct tservice_s tservice[TIMER_SERVICES];
+
+/*
+ * a timer may also be bound to a task, for periodic task releases. when it
+ * expires, no callback is called: the task is released instead (it is made
+ * ready if blocked in ucx_timer_wait()), so periodic work runs in the task
+ * context, at the task priority. releases not consumed in time are counted
+ * as overruns of the task (see krnl_task_release()).
+ */
+
+/* queues an expired timer to its service (inside a critical section) */
+static void tservice_post(struct timer_s *timer, uint64_t arg)
 {
-	struct timer_s *timer = node->data;
-	uint32_t tick_diff = (size_t)arg;
+	struct tservice_s *ts = &tservice[timer->service];
+	
+	if (timer->pending) {
+		timer->overruns++;
+		return;
+	}
+	
+	timer->pending = 1;
+	timer->arg = arg;
+	timer->qnext = 0;
+	if (ts->tail)
+		ts->tail->qnext = timer;
+	else
+		ts->head = timer;
+	ts->tail = timer;
+	
+	if (ts->task && ts->task->state == TASK_BLOCKED)
+		ts->task->state = TASK_READY;
+}
 
-	if (timer->mode == TIMER_DISABLED)
-		return 0;
+/* removes a timer from its service queue (inside a critical section) */
+static void tservice_remove(struct timer_s *timer)
+{
+	struct tservice_s *ts;
+	struct timer_s *prev;
+	
+	if (!timer->pending)
+		return;
+	
+	ts = &tservice[timer->service];
+	if (ts->head == timer) {
+		ts->head = timer->qnext;
+		prev = 0;
+	} else {
+		for (prev = ts->head; prev->qnext != timer; prev = prev->qnext);
+		prev->qnext = timer->qnext;
+	}
+	if (ts->tail == timer)
+		ts->tail = prev;
 	
-	while (timer->countdown && tick_diff) {
-		timer->countdown--;
-		tick_diff--;
+	timer->qnext = 0;
+	timer->pending = 0;
+}
+
+static struct timer_s **twheel;
+static uint32_t twheel_tick;		/* next tick to be processed */
+
+/* timing wheel operations must be called inside a critical section */
+
+/* expiration tick, aligned inside the slack window [expires, expires + slack] */
+static uint32_t twheel_due(struct timer_s *timer)
+{
+	uint32_t due, diff;
+	
+	if (!timer->slack)
+		return timer->expires;
+	
+	due = timer->expires + timer->slack;
+	diff = (timer->expires - 1) ^ due;
+	while (diff & (diff - 1))
+		diff &= diff - 1;
+	
+	return due & ~(diff - 1);
+}
+
+static void twheel_insert(struct timer_s *timer)
+{
+	struct timer_s **slot;
+	uint32_t expires = twheel_due(timer);
+	int32_t delta = expires - twheel_tick;
+	int level;
+	
+	if (delta < 0) {
+		slot = &twheel[twheel_tick & TWHEEL_MASK];
+	} else {
+		if ((uint32_t)delta > TWHEEL_MAX) {
+			delta = TWHEEL_MAX;
+			expires = twheel_tick + TWHEEL_MAX;
+		}
+		
+		for (level = 0; level < TWHEEL_LEVELS - 1; level++)
+			if ((uint32_t)delta < (1UL << (TWHEEL_BITS * (level + 1))))
+				break;
+		
+		slot = &twheel[level * TWHEEL_SIZE + ((expires >> (TWHEEL_BITS * level)) & TWHEEL_MASK)];
 	}
 	
-	if (!timer->countdown) {
-		timer->timer_cb(arg);
-		if (timer->mode == TIMER_AUTORELOAD)
-			timer->countdown = timer->time;
-		else
-			timer->mode = TIMER_DISABLED;
+	timer->next = *slot;
+	if (timer->next)
+		timer->next->pprev = &timer->next;
+	timer->pprev = slot;
+	*slot = timer;
+}
+
+static void twheel_remove(struct timer_s *timer)
+{
+	if (!timer->pprev)
+		return;
+	
+	*timer->pprev = timer->next;
+	if (timer->next)
+		timer->next->pprev = timer->pprev;
+	timer->pprev = 0;
+}
+
+static void twheel_cascade(int level)
+{
+	struct timer_s *timer, *next, **slot;
+	
+	slot = &twheel[level * TWHEEL_SIZE + ((twheel_tick >> (TWHEEL_BITS * level)) & TWHEEL_MASK)];
+	timer = *slot;
+	*slot = 0;
+	
+	while (timer) {
+		next = timer->next;
+		timer->pprev = 0;
+		twheel_insert(timer);
+		timer = next;
 	}
+}
+
+static void twheel_add(struct timer_s *timer)
+{
+	if (timer->mode != TIMER_DISABLED) {
+		timer->expires = twheel_tick + timer->countdown;
+		twheel_insert(timer);
+	}
+}
+
+static int32_t twheel_init(void)
+{
+	int i;
+	
+	twheel = malloc(sizeof(struct timer_s *) * TWHEEL_LEVELS * TWHEEL_SIZE);
+	
+	if (!twheel)
+		return ERR_FAIL;
+	
+	for (i = 0; i < TWHEEL_LEVELS * TWHEEL_SIZE; i++)
+		twheel[i] = 0;
+	
+	CRITICAL_ENTER();
+	twheel_tick = kcb->ticks;
+	for (i = 0; i < tslot_size; i++)
+		if (tslot[i].timer)
+			twheel_add(tslot[i].timer);
+	CRITICAL_LEAVE();
 	
-	return 0;
+	return ERR_OK;
 }
 
-static struct node_s *timer_update(struct node_s *node, void *arg)
+/*
+ * the current slot is moved to a local list, so reloaded timers are not
+ * expired again in the same tick and timers can still be canceled while
+ * callbacks are executed.
+ */
+static void twheel_expire(uint32_t tick)
 {
-	struct timer_s *timer = node->data;
-	uint64_t time = (size_t)arg;
+	struct timer_s *timer, *expired;
+	void *(*timer_cb)(void *arg);
+	uint16_t task_id;
+	uint32_t timer_id = 0;
+	int level;
+	
+	CRITICAL_ENTER();
+	for (level = 1; level < TWHEEL_LEVELS; level++) {
+		if (twheel_tick & ((1UL << (TWHEEL_BITS * level)) - 1))
+			break;
+		twheel_cascade(level);
+	}
+	expired = twheel[twheel_tick & TWHEEL_MASK];
+	twheel[twheel_tick & TWHEEL_MASK] = 0;
+	if (expired)
+		expired->pprev = &expired;
+	twheel_tick++;
+	CRITICAL_LEAVE();
+	
+	while (1) {
+		CRITICAL_ENTER();
+		timer = expired;
+		timer_cb = 0;
+		task_id = TIMER_UNBOUND;
+		if (timer) {
+			twheel_remove(timer);
+			if (timer->mode == TIMER_AUTORELOAD) {
+				timer->expires += timer->time;
+				twheel_insert(timer);
+			} else {
+				timer->mode = TIMER_DISABLED;
+			}
+			if (timer->task != TIMER_UNBOUND) {
+				task_id = timer->task;
+				timer_id = timer->timer_id;
+			} else if (timer->service == TIMER_INLINE) {
+				timer_cb = timer->timer_cb;
+			} else {
+				tservice_post(timer, tick);
+			}
+		}
+		CRITICAL_LEAVE();
+		
+		if (!timer)
+			break;
+		
+		/* if the bound task no longer exists, the timer is stopped */
+		if (task_id != TIMER_UNBOUND) {
+			if (krnl_task_release(task_id))
+				ucx_timer_cancel(timer_id);
+		} else if (timer_cb) {
+			timer_cb((void *)(size_t)tick);
+		}
+	}
+}
 
-	if (timer->mode == TIMER_DISABLED)
-		return 0;
+/*
+ * uptime based timers are kept in a binary min-heap ordered by timecmp, built
+ * when timer_handler() is first called. timers are inserted and removed in
+ * O(log n) and the earliest deadline is always at the root, so the handler
+ * only checks the root and sleeps until the next deadline. each timer keeps
+ * its heap index, so it can be canceled without a search. the heap has room
+ * for all timers, and it is grown when timers are created.
+ * 
+ * - while the root timer is due:
+ * 	* remove it from the heap
+ * 	* if TIMER_AUTORELOAD, update timecmp and insert it again
+ * 	* if TIMER_ONESHOT, set TIMER_DISABLED
+ * 	* call timer callback
+ * - sleep until the next deadline (or until a timer is started)
+ * 
+ * a timer with slack may be called up to 'slack' ms after its deadline, so
+ * the handler sleeps until the earliest latest deadline (timecmp + slack) and
+ * then calls all due timers at once. only timers that may expire before the
+ * root timer latest deadline are visited to find it (at most THEAP_SCAN).
+ */
+
+static struct timer_s **theap;
+static uint16_t theap_len, theap_size;
+static struct tcb_s *theap_task;	/* timer task, while sleeping */
+static uint64_t theap_wake;		/* timer task wakeup time, while sleeping */
+
+/* deadline heap operations must be called inside a critical section */
+static void theap_set(uint16_t i, struct timer_s *timer)
+{
+	theap[i] = timer;
+	timer->hidx = i;
+}
+
+static void theap_up(uint16_t i)
+{
+	struct timer_s *timer = theap[i];
+	uint16_t parent;
+	
+	while (i > 0) {
+		parent = (i - 1) >> 1;
+		if (theap[parent]->timecmp <= timer->timecmp)
+			break;
+		theap_set(i, theap[parent]);
+		i = parent;
+	}
+	theap_set(i, timer);
+}
+
+static void theap_down(uint16_t i)
+{
+	struct timer_s *timer = theap[i];
+	uint16_t child;
+	
+	while ((child = (i << 1) + 1) < theap_len) {
+		if (child + 1 < theap_len && theap[child + 1]->timecmp < theap[child]->timecmp)
+			child++;
+		if (timer->timecmp <= theap[child]->timecmp)
+			break;
+		theap_set(i, theap[child]);
+		i = child;
+	}
+	theap_set(i, timer);
+}
+
+static void theap_insert(struct timer_s *timer)
+{
+	if (timer->hidx != THEAP_NONE || theap_len == theap_size)
+		return;
+	
+	theap_set(theap_len, timer);
+	theap_up(theap_len++);
+}
+
+static void theap_remove(struct timer_s *timer)
+{
+	struct timer_s *last;
+	uint16_t i = timer->hidx;
+	
+	if (i == THEAP_NONE)
+		return;
+	
+	timer->hidx = THEAP_NONE;
+	
+	if (i == --theap_len)
+		return;
+	
+	last = theap[theap_len];
+	theap_set(i, last);
+	theap_down(i);
+	theap_up(last->hidx);
+}
+
+/* grows the heap to 'size' entries, out of a critical section */
+static int32_t theap_grow(uint16_t size)
+{
+	struct timer_s **heap, **old;
+	uint16_t i;
+	
+	heap = malloc(sizeof(struct timer_s *) * size);
+	
+	if (!heap)
+		return ERR_FAIL;
+	
+	CRITICAL_ENTER();
+	if (size <= theap_size) {
+		CRITICAL_LEAVE();
+		free(heap);
+		
+		return ERR_OK;
+	}
+	for (i = 0; i < theap_len; i++)
+		heap[i] = theap[i];
+	old = theap;
+	theap = heap;
+	theap_size = size;
+	CRITICAL_LEAVE();
+	
+	if (old)
+		free(old);
+	
+	return ERR_OK;
+}
+
+static int32_t theap_init(void)
+{
+	int i;
+	
+	if (theap_grow(tslot_size > 8 ? tslot_size : 8))
+		return ERR_FAIL;
 	
-	if (time > timer->timecmp) {
-		timer->timer_cb(arg);
-		if (timer->mode == TIMER_AUTORELOAD)
-			timer->timecmp += timer->time;
-		else
-			timer->mode = TIMER_DISABLED;
+	CRITICAL_ENTER();
+	for (i = 0; i < tslot_size; i++)
+		if (tslot[i].timer && tslot[i].timer->mode != TIMER_DISABLED)
+			theap_insert(tslot[i].timer);
+	CRITICAL_LEAVE();
+	
+	return ERR_OK;
+}
+
+/*
+ * earliest latest deadline (timecmp + slack) of heap timers. subtrees with a
+ * timecmp after the current result are skipped, and at most THEAP_SCAN
+ * timers are visited. a timer which is not visited due to this bound limits
+ * the result to its timecmp, so no timer is delayed past its slack.
+ */
+static uint64_t theap_latest(void)
+{
+	struct timer_s *timer;
+	uint16_t stack[THEAP_SCAN + 1], i, child;
+	uint64_t latest;
+	int top = 0, visits = 0;
+	
+	latest = theap[0]->timecmp + theap[0]->slack;
+	stack[top++] = 0;
+	
+	while (top) {
+		i = stack[--top];
+		timer = theap[i];
+		if (timer->timecmp > latest)
+			continue;
+		
+		if (visits == THEAP_SCAN) {
+			latest = timer->timecmp;
+			continue;
+		}
+		visits++;
+		
+		if (timer->timecmp + timer->slack < latest)
+			latest = timer->timecmp + timer->slack;
+		
+		for (child = (i << 1) + 1; child <= (i << 1) + 2 && child < theap_len; child++)
+			stack[top++] = child;
 	}
 	
-	return 0;
+	return latest;
+}
+
+/* wakes up the timer task if a timer must expire before it wakes (inside a critical section) */
+static void theap_wakeup(struct timer_s *timer)
+{
+	if (theap_task && theap_task->state == TASK_BLOCKED &&
+	    (timer->hidx == 0 || timer->timecmp + timer->slack < theap_wake)) {
+		theap_task->delay = 0;
+		theap_task->state = TASK_READY;
+	}
 }
 
 
@@ -64,107 +469,309 @@ static struct node_s *timer_update(struct node_s *node, void *arg)
 
 void timer_handler_systick()
 {
-	static uint32_t last_tick;
-	uint32_t tick_diff;
+	if (!twheel && twheel_init())
+		return;
 	
-	if (!last_tick) {
-		last_tick = kcb->ticks;
-		
+	while ((int32_t)(kcb->ticks - twheel_tick) >= 0)
+		twheel_expire(twheel_tick);
+	
+	ucx_task_yield();
+}
+
+void timer_handler()
+{
+	struct timer_s *timer;
+	struct tcb_s *task;
+	void *(*timer_cb)(void *arg);
+	uint64_t time, wait, wake;
+	uint16_t task_id;
+	uint32_t timer_id = 0;
+	
+	if (!theap && theap_init())
 		return;
+	
+	time = ucx_uptime();
+	
+	while (1) {
+		CRITICAL_ENTER();
+		timer = theap_len && time > theap[0]->timecmp ? theap[0] : 0;
+		timer_cb = 0;
+		task_id = TIMER_UNBOUND;
+		
+		if (timer) {
+			theap_remove(timer);
+			if (timer->mode == TIMER_AUTORELOAD) {
+				timer->timecmp += timer->time;
+				theap_insert(timer);
+			} else {
+				timer->mode = TIMER_DISABLED;
+			}
+			if (timer->task != TIMER_UNBOUND) {
+				task_id = timer->task;
+				timer_id = timer->timer_id;
+			} else if (timer->service == TIMER_INLINE) {
+				timer_cb = timer->timer_cb;
+			} else {
+				tservice_post(timer, time);
+			}
+		}
+		CRITICAL_LEAVE();
+		
+		if (!timer)
+			break;
+		
+		/* if the bound task no longer exists, the timer is stopped */
+		if (task_id != TIMER_UNBOUND) {
+			if (krnl_task_release(task_id))
+				ucx_timer_cancel(timer_id);
+		} else if (timer_cb) {
+			timer_cb((void *)(size_t)time);
+		}
+	}
+	
+	/* callbacks may take a while, so the sleep is computed from the current uptime */
+	time = ucx_uptime();
+	
+	CRITICAL_ENTER();
+	task = kcb->task_current->data;
+	
+	if (theap_len) {
+		wake = theap_latest();
+		if (wake < time) {
+			task->delay = 0;
+		} else {
+			/* at least one tick, so a deadline closer than a tick is not polled */
+			wait = MS_TO_TICKS(wake + 1 - time);
+			task->delay = !wait ? 1 : wait > 0xfffe ? 0xfffe : wait;
+		}
+	} else {
+		wake = ~0ULL;
+		task->delay = 0;
 	}
 	
-	if (kcb->ticks != last_tick) {
-		tick_diff = kcb->ticks - last_tick;
-		last_tick = kcb->ticks;
-		list_foreach(kcb->timer_lst, timer_update_systick, (void *)(size_t)tick_diff);
+	if (task->delay || !theap_len) {
+		task->state = TASK_BLOCKED;
+		theap_task = task;
+		theap_wake = wake;
 	}
+	CRITICAL_LEAVE();
 	
 	ucx_task_yield();
+	
+	CRITICAL_ENTER();
+	theap_task = 0;
+	CRITICAL_LEAVE();
 }
 
-void timer_handler()
+
+/*
+ * timer service task body, for a given service. queued timer callbacks are
+ * called in expiration order, then the task blocks until a timer is queued.
+ * service tasks are regular tasks, so their priority is set as usual.
+ */
+void timer_service(uint8_t service)
 {
-	uint64_t time;
+	struct tservice_s *ts;
+	struct timer_s *timer;
+	struct tcb_s *task;
+	void *(*timer_cb)(void *arg);
+	uint64_t arg = 0;
 	
-	time = ucx_uptime();
-	list_foreach(kcb->timer_lst, timer_update, (void *)(size_t)time);
+	if (service >= TIMER_SERVICES) {
+		ucx_task_yield();
+		return;
+	}
+	
+	ts = &tservice[service];
+	
+	while (1) {
+		CRITICAL_ENTER();
+		timer = ts->head;
+		timer_cb = 0;
+		if (timer) {
+			timer_cb = timer->timer_cb;
+			arg = timer->arg;
+			tservice_remove(timer);
+		}
+		CRITICAL_LEAVE();
+		
+		if (!timer)
+			break;
+		
+		timer_cb((void *)(size_t)arg);
+	}
+	
+	CRITICAL_ENTER();
+	task = kcb->task_current->data;
+	if (!ts->head) {
+		task->delay = 0;
+		task->state = TASK_BLOCKED;
+		ts->task = task;
+	}
+	CRITICAL_LEAVE();
 	
 	ucx_task_yield();
+	
+	CRITICAL_ENTER();
+	ts->task = 0;
+	CRITICAL_LEAVE();
+}
+
+
+/*
+ * doubles the slot table (up to TSLOT_MAX slots), out of a critical section.
+ * new slots are chained to the free list. if the table was grown meanwhile
+ * (by another task), the new table is discarded.
+ */
+static int32_t tslot_grow(void)
+{
+	struct tslot_s *slots, *old;
+	uint32_t size, old_size, i;
+	
+	old_size = tslot_size;
+	if (old_size == TSLOT_MAX)
+		return ERR_FAIL;
+	
+	size = old_size ? old_size << 1 : 8;
+	if (size > TSLOT_MAX)
+		size = TSLOT_MAX;
+	
+	slots = malloc(sizeof(struct tslot_s) * size);
+	if (!slots)
+		return ERR_FAIL;
+	
+	for (i = old_size; i < size; i++) {
+		slots[i].timer = 0;
+		slots[i].gen = 0;
+		slots[i].free = i + 1;
+	}
+	
+	CRITICAL_ENTER();
+	if (tslot_size != old_size) {
+		CRITICAL_LEAVE();
+		free(slots);
+		
+		return ERR_OK;
+	}
+	for (i = 0; i < old_size; i++)
+		slots[i] = tslot[i];
+	slots[size - 1].free = tslot_free;
+	tslot_free = old_size;
+	old = tslot;
+	tslot = slots;
+	tslot_size = size;
+	CRITICAL_LEAVE();
+	
+	if (old)
+		free(old);
+	
+	return ERR_OK;
+}
+
+/* maps a timer handle to its timer, checking the slot generation */
+static struct timer_s *tslot_lookup(uint32_t timer_id)
+{
+	struct timer_s *timer;
+	uint32_t slot = timer_id & TSLOT_MASK;
+	
+	if (slot >= tslot_size)
+		return 0;
+	
+	timer = tslot[slot].timer;
+	if (!timer || timer->timer_id != timer_id)
+		return 0;
+	
+	return timer;
 }
 
 
 /*
  * creates a new timer
- * - if kcb->timer_lst is empty, create a list
- * - create a struct timer_s, fill it and add to the list
+ * - create a struct timer_s and fill it
+ * - claim a free slot, growing the slot table if needed
  * - return timer_id on success (ERR_OK) or error (ERR_FAIL)
  */
 int32_t ucx_timer_create(void *(*timer_cb)(void *arg), uint32_t time)
 {
-	struct node_s *node;
 	struct timer_s *timer;
-	static uint16_t timer_id = 0x6000;
+	uint16_t slot;
 	
-	if (!kcb->timer_lst)
-		kcb->timer_lst = list_create();
-
-	if (!kcb->timer_lst)
+	if (theap && theap_size <= tslot_count &&
+	    theap_grow(theap_size < (TSLOT_MAX >> 1) ? theap_size << 1 : TSLOT_MAX))
 		return ERR_FAIL;
-		
+	
 	timer = malloc(sizeof(struct timer_s));
 	if (!timer)
 		return ERR_FAIL;
-		
-	node = list_pushback(kcb->timer_lst, timer);
-	if (!node) {
-		free(timer);
-		return ERR_FAIL;
-	}
-		
-	timer->timer_id = timer_id++;
+	
 	timer->timer_cb = timer_cb;
 	timer->time = time;
 	timer->countdown = time;
 	timer->timecmp = 0;
+	timer->expires = 0;
+	timer->next = 0;
+	timer->pprev = 0;
+	timer->hidx = THEAP_NONE;
+	timer->qnext = 0;
+	timer->arg = 0;
+	timer->overruns = 0;
+	timer->slack = 0;
+	timer->task = TIMER_UNBOUND;
+	timer->service = TIMER_INLINE;
+	timer->pending = 0;
 	timer->mode = TIMER_DISABLED;
 	
-	return timer->timer_id;
-}
-
-
-static struct node_s *timer_id_cmp(struct node_s *node, void *arg)
-{
-	struct timer_s *timer = node->data;
-	uint16_t timer_id = (size_t)arg;
+	while (1) {
+		CRITICAL_ENTER();
+		slot = tslot_free;
+		if (slot != TSLOT_NONE) {
+			tslot_free = tslot[slot].free;
+			timer->timer_id = ((uint32_t)tslot[slot].gen << TSLOT_BITS) | slot;
+			tslot[slot].timer = timer;
+			tslot_count++;
+		}
+		CRITICAL_LEAVE();
+		
+		if (slot != TSLOT_NONE)
+			break;
+		
+		if (tslot_grow()) {
+			free(timer);
+			
+			return ERR_FAIL;
+		}
+	}
 	
-	if (timer->timer_id == timer_id)
-		return node;
-	else
-		return 0;
+	return timer->timer_id;
 }
 
 /*
- * removes a timer from the list
- * - iterate the list to find a struct timer_s with the timer_id
- * - remove struct timer_s from the list
+ * removes a timer
+ * - find the struct timer_s referenced by timer_id
+ * - release the slot (a new generation invalidates the handle)
  * - return ERR_OK on success or error
  */
 
-int32_t ucx_timer_destroy(uint16_t timer_id)
+int32_t ucx_timer_destroy(uint32_t timer_id)
 {
-	struct node_s *node;
 	struct timer_s *timer;
+	uint16_t slot = timer_id & TSLOT_MASK;
 	
-	if (!kcb->timer_lst)
-		return ERR_FAIL;
-		
-	node = list_foreach(kcb->timer_lst, timer_id_cmp, (void *)(size_t)timer_id);
-	if (!node)
+	timer = tslot_lookup(timer_id);
+	if (!timer)
 		return ERR_FAIL;
 	
-	timer = node->data;
+	CRITICAL_ENTER();
+	twheel_remove(timer);
+	theap_remove(timer);
+	tservice_remove(timer);
+	tslot[slot].timer = 0;
+	tslot[slot].gen = (tslot[slot].gen + 1) & TSLOT_GEN_MASK;
+	tslot[slot].free = tslot_free;
+	tslot_free = slot;
+	tslot_count--;
+	CRITICAL_LEAVE();
 	free(timer);
-	list_remove(kcb->timer_lst, node);
 	
 	return ERR_OK;
 }
@@ -172,25 +779,39 @@ int32_t ucx_timer_destroy(uint16_t timer_id)
 /*
  * starts a timer countdown
  * - sets timer compare and set timer mode
+ * - (re)inserts the timer in the timing wheel, if systick timers are used
+ * - (re)inserts the timer in the deadline heap, if uptime timers are used
  * - return ERR_OK or error
  */
-int32_t ucx_timer_start(uint16_t timer_id, uint8_t mode)
+int32_t ucx_timer_start(uint32_t timer_id, uint8_t mode)
 {
-	struct node_s *node;
 	struct timer_s *timer;
+	uint64_t time;
 	
-	if (!kcb->timer_lst)
-		return ERR_FAIL;
-		
-	node = list_foreach(kcb->timer_lst, timer_id_cmp, (void *)(size_t)timer_id);
-	if (!node)
+	timer = tslot_lookup(timer_id);
+	if (!timer)
 		return ERR_FAIL;
 	
-	timer = node->data;
+	time = ucx_uptime();
+	
+	CRITICAL_ENTER();
 	timer->countdown = timer->time;
-	timer->timecmp = ucx_uptime() + timer->time;
+	timer->timecmp = time + timer->time;
 	timer->mode = mode;
 	
+	if (twheel) {
+		twheel_remove(timer);
+		timer->expires = kcb->ticks + timer->time;
+		twheel_insert(timer);
+	}
+	
+	if (theap) {
+		theap_remove(timer);
+		theap_insert(timer);
+		theap_wakeup(timer);
+	}
+	CRITICAL_LEAVE();
+	
 	return ERR_OK;
 }
 
@@ -199,20 +820,160 @@ int32_t ucx_timer_start(uint16_t timer_id, uint8_t mode)
  * - sets TIMER_DISABLED
  * - return ERR_OK or error
  */
-int32_t ucx_timer_cancel(uint16_t timer_id)
+int32_t ucx_timer_cancel(uint32_t timer_id)
+{
+	struct timer_s *timer;
+	
+	timer = tslot_lookup(timer_id);
+	if (!timer)
+		return ERR_FAIL;
+	
+	CRITICAL_ENTER();
+	timer->mode = TIMER_DISABLED;
+	twheel_remove(timer);
+	theap_remove(timer);
+	tservice_remove(timer);
+	CRITICAL_LEAVE();
+	
+	return ERR_OK;
+}
+
+/*
+ * sets the timer slack (in the same unit as the timer period)
+ * - the timer may expire up to 'slack' late, so it can be grouped with others
+ * - an active systick timer is inserted again in the timing wheel
+ * - return ERR_OK or error
+ */
+int32_t ucx_timer_slack(uint32_t timer_id, uint32_t slack)
+{
+	struct timer_s *timer;
+	
+	timer = tslot_lookup(timer_id);
+	if (!timer)
+		return ERR_FAIL;
+	
+	CRITICAL_ENTER();
+	timer->slack = slack;
+	if (timer->pprev) {
+		twheel_remove(timer);
+		twheel_insert(timer);
+	}
+	if (timer->hidx != THEAP_NONE)
+		theap_wakeup(timer);
+	CRITICAL_LEAVE();
+	
+	return ERR_OK;
+}
+
+/*
+ * assigns a timer to a service (or TIMER_INLINE, the default)
+ * - a pending callback is moved to the new service
+ * - return ERR_OK or error
+ */
+int32_t ucx_timer_service(uint32_t timer_id, uint8_t service)
+{
+	struct timer_s *timer;
+	uint8_t pending;
+	
+	if (service >= TIMER_SERVICES && service != TIMER_INLINE)
+		return ERR_FAIL;
+	
+	timer = tslot_lookup(timer_id);
+	if (!timer)
+		return ERR_FAIL;
+	
+	CRITICAL_ENTER();
+	pending = timer->pending;
+	tservice_remove(timer);
+	timer->service = service;
+	if (pending && service != TIMER_INLINE)
+		tservice_post(timer, timer->arg);
+	CRITICAL_LEAVE();
+	
+	return ERR_OK;
+}
+
+/*
+ * returns the number of timer overruns (expirations of a timer while its
+ * callback was still waiting on a service queue) and clears the counter
+ */
+int32_t ucx_timer_overruns(uint32_t timer_id)
+{
+	struct timer_s *timer;
+	uint32_t overruns;
+	
+	timer = tslot_lookup(timer_id);
+	if (!timer)
+		return ERR_FAIL;
+	
+	CRITICAL_ENTER();
+	overruns = timer->overruns;
+	timer->overruns = 0;
+	CRITICAL_LEAVE();
+	
+	return overruns & 0x7fffffff;
+}
+
+/*
+ * binds a timer to a task (or TIMER_UNBOUND, the default)
+ * - on expiration, the task is released instead of calling the callback
+ * - fails if the task doesn't exist (ERR_TASK_NOT_FOUND) or if the timer
+ *   callback is pending on a service queue (ERR_FAIL)
+ * - return ERR_OK or error
+ */
+int32_t ucx_timer_bind_task(uint32_t timer_id, uint16_t task_id)
 {
-	struct node_s *node;
 	struct timer_s *timer;
 	
-	if (!kcb->timer_lst)
+	timer = tslot_lookup(timer_id);
+	if (!timer)
 		return ERR_FAIL;
+	
+	CRITICAL_ENTER();
+	if (task_id != TIMER_UNBOUND && !krnl_task_lookup(task_id)) {
+		CRITICAL_LEAVE();
+		
+		return ERR_TASK_NOT_FOUND;
+	}
+	
+	if (timer->pending) {
+		CRITICAL_LEAVE();
 		
-	node = list_foreach(kcb->timer_lst, timer_id_cmp, (void *)(size_t)timer_id);
-	if (!node)
 		return ERR_FAIL;
+	}
 	
-	timer = node->data;
-	timer->mode = TIMER_DISABLED;
+	timer->task = task_id;
+	CRITICAL_LEAVE();
 	
 	return ERR_OK;
 }
+
+/*
+ * waits for the next periodic release of the current task (by a bound timer)
+ * - returns at once if a release is pending
+ * - return the number of releases missed since the last call
+ */
+int32_t ucx_timer_wait(void)
+{
+	struct tcb_s *task;
+	uint16_t missed;
+	
+	CRITICAL_ENTER();
+	task = kcb->task_current->data;
+	
+	while (!task->releases) {
+		task->rwait = 1;
+		task->delay = 0;
+		task->state = TASK_BLOCKED;
+		CRITICAL_LEAVE();
+		ucx_task_yield();
+		CRITICAL_ENTER();
+	}
+	
+	task->rwait = 0;
+	missed = task->releases - 1;
+	task->releases = 0;
+	CRITICAL_LEAVE();
+	
+	return missed;
+}
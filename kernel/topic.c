@@ -0,0 +1,179 @@
+/* file:          topic.c
+ * description:   publish / subscribe topics with zero-copy buffers
+ * date:          10/2026
+ */
+
+#include <ucx.h>
+
+/*
+ * Topic buffers are allocated from a memory pool owned by the topic. A single
+ * buffer is published to all subscribers: the same message pointer is put in
+ * each subscriber message queue, and the buffer is returned to the pool when
+ * the last subscriber releases it. The message header is the first member, so
+ * message pointers map directly to buffers.
+ */
+struct tbuf_s {
+	struct message_s msg;
+	struct topic_s *topic;
+	volatile int32_t refs;
+};
+
+/* grows the subscriber table (out of a critical section) */
+static int32_t topic_grow(struct topic_s *t)
+{
+	struct mq_s **subs, **old;
+	uint16_t size, i;
+	
+	size = t->size << 1;
+	subs = malloc(sizeof(struct mq_s *) * size);
+	
+	if (!subs)
+		return -1;
+	
+	CRITICAL_ENTER();
+	for (i = 0; i < t->nsubs; i++)
+		subs[i] = t->subs[i];
+	old = t->subs;
+	t->subs = subs;
+	t->size = size;
+	CRITICAL_LEAVE();
+	
+	free(old);
+	
+	return 0;
+}
+
+struct topic_s *ucx_topic_create(uint16_t size, uint16_t buffers)
+{
+	struct topic_s *t;
+	
+	t = malloc(sizeof(struct topic_s));
+	
+	if (!t)
+		return 0;
+	
+	t->subs = malloc(sizeof(struct mq_s *) * TOPIC_SUBS);
+	
+	if (!t->subs) {
+		free(t);
+		return 0;
+	}
+	
+	t->pool = ucx_mpool_create(sizeof(struct tbuf_s) + size, buffers);
+	
+	if (!t->pool) {
+		free(t->subs);
+		free(t);
+		return 0;
+	}
+	
+	t->nsubs = 0;
+	t->size = TOPIC_SUBS;
+	
+	return t;
+}
+
+int32_t ucx_topic_destroy(struct topic_s *t)
+{
+	if (t->nsubs)
+		return -1;
+	
+	if (ucx_mpool_destroy(t->pool))
+		return -1;
+	
+	free(t->subs);
+	free(t);
+	
+	return 0;
+}
+
+int32_t ucx_topic_subscribe(struct topic_s *t, struct mq_s *mq)
+{
+	int32_t status = -1;
+	
+	if (t->nsubs == t->size && topic_grow(t))
+		return -1;
+	
+	CRITICAL_ENTER();
+	if (t->nsubs < t->size) {
+		t->subs[t->nsubs++] = mq;
+		status = 0;
+	}
+	CRITICAL_LEAVE();
+	
+	return status;
+}
+
+int32_t ucx_topic_unsubscribe(struct topic_s *t, struct mq_s *mq)
+{
+	int32_t status = -1;
+	uint16_t i;
+	
+	CRITICAL_ENTER();
+	for (i = 0; i < t->nsubs; i++) {
+		if (t->subs[i] == mq) {
+			t->subs[i] = t->subs[--t->nsubs];
+			status = 0;
+			break;
+		}
+	}
+	CRITICAL_LEAVE();
+	
+	return status;
+}
+
+/* allocates a buffer to be filled by the publisher (data / size) */
+struct message_s *ucx_topic_alloc(struct topic_s *t)
+{
+	struct tbuf_s *buf;
+	
+	buf = ucx_mpool_alloc(t->pool);
+	
+	if (!buf)
+		return 0;
+	
+	buf->msg.data = buf + 1;
+	buf->msg.type = 0;
+	buf->msg.size = t->pool->bsize - sizeof(struct tbuf_s);
+	buf->topic = t;
+	buf->refs = 1;
+	
+	return &buf->msg;
+}
+
+/*
+ * publishes a buffer to all subscribers, returning the number of subscribers
+ * it was delivered to (subscribers with a full queue miss the message). the
+ * subscriber table is walked and a reference is taken for each delivery in a
+ * single critical section, so subscriptions can't change during the walk and
+ * no subscriber runs (and releases the buffer) before all references are
+ * taken. the publisher reference is released at the end.
+ */
+int32_t ucx_topic_publish(struct topic_s *t, struct message_s *m)
+{
+	struct tbuf_s *buf = (struct tbuf_s *)m;
+	int32_t delivered = 0;
+	uint16_t i;
+	
+	CRITICAL_ENTER();
+	for (i = 0; i < t->nsubs; i++)
+		if (!krnl_mq_enqueue(t->subs[i], m))
+			delivered++;
+	buf->refs += delivered;
+	CRITICAL_LEAVE();
+	
+	ucx_topic_release(m);
+	
+	return delivered;
+}
+
+/* releases a reference to a buffer, returning it to the pool on the last one */
+int32_t ucx_topic_release(struct message_s *m)
+{
+	struct tbuf_s *buf = (struct tbuf_s *)m;
+	
+	if (_atomic_add(&buf->refs, -1) == 1)
+		return ucx_mpool_free(buf->topic->pool, buf);
+	
+	return 0;
+}
@@ -10,7 +10,8 @@ struct kcb_s kernel_state = {
 	.tasks = 0,
 	.task_current = 0,
 	.rt_sched = krnl_noop_rtsched,
-	.timer_lst = 0,
+	.select_lst = 0,
+	.await_lst = 0,
 	.id_next = 0,
 	.ticks = 0
 };
@@ -68,6 +69,56 @@ static struct node_s *refcmp(struct node_s *node, void *arg)
 		return 0;
 }
 
+/*
+ * Task id table. Task ids are assigned in sequence and never reused, so the
+ * table is indexed directly by the id and grown (doubled) as tasks are
+ * spawned. Canceled tasks leave an empty entry. It is used by calls which may
+ * be frequent, such as notifications and periodic releases, to map an id to a
+ * TCB in constant time, instead of searching the task list.
+ */
+static struct tcb_s **task_tbl;
+static uint32_t task_tbl_size;
+
+/* grows the table to hold 'id' (out of a critical section) */
+static int32_t task_tbl_grow(uint16_t id)
+{
+	struct tcb_s **tbl, **old;
+	uint32_t size, i;
+	
+	size = task_tbl_size ? task_tbl_size : 8;
+	while (size <= id)
+		size <<= 1;
+	if (size > 0x10000)
+		size = 0x10000;
+	
+	tbl = malloc(sizeof(struct tcb_s *) * size);
+	
+	if (!tbl)
+		return ERR_FAIL;
+	
+	for (i = 0; i < size; i++)
+		tbl[i] = 0;
+	
+	CRITICAL_ENTER();
+	for (i = 0; i < task_tbl_size; i++)
+		tbl[i] = task_tbl[i];
+	old = task_tbl;
+	task_tbl = tbl;
+	task_tbl_size = size;
+	CRITICAL_LEAVE();
+	
+	if (old)
+		free(old);
+	
+	return ERR_OK;
+}
+
+/* maps a task id to its TCB (inside a critical section) */
+struct tcb_s *krnl_task_lookup(uint16_t id)
+{
+	return id < task_tbl_size ? task_tbl[id] : 0;
+}
+
 void krnl_panic(uint32_t ecode)
 {
 	int err;
@@ -89,6 +140,11 @@ void krnl_panic(uint32_t ecode)
  
 void _dispatch(void) __attribute__ ((weak, alias ("dispatch")));
 void _yield(void) __attribute__ ((weak, alias ("yield")));
+int32_t _atomic_add(volatile int32_t *ptr, int32_t val) __attribute__ ((weak, alias ("atomic_add")));
+int32_t _atomic_cas(volatile int32_t *ptr, int32_t oldval, int32_t newval) __attribute__ ((weak, alias ("atomic_cas")));
+int32_t _hrtimer_set(uint64_t deadline) __attribute__ ((weak, alias ("hrtimer_set")));
+uint64_t _read_cycles(void) __attribute__ ((weak, alias ("read_cycles")));
+uint32_t _cycles_freq(void) __attribute__ ((weak, alias ("cycles_freq")));
 
 /*
  * The scheduler switches tasks based on task states and priorities, using
@@ -192,6 +248,232 @@ void yield(void)
 }
 
 
+/*
+ * Atomic operations, used by lock-free fast paths. Architectures with atomic
+ * instructions (such as LDREX / STREX or the RISC-V A extension) implement
+ * _atomic_add() and _atomic_cas() in the HAL. The default implementation below
+ * disables interrupts, and must not be called inside a critical section.
+ */
+
+int32_t atomic_add(volatile int32_t *ptr, int32_t val)
+{
+	int32_t old;
+	
+	CRITICAL_ENTER();
+	old = *ptr;
+	*ptr = old + val;
+	CRITICAL_LEAVE();
+	
+	return old;
+}
+
+int32_t atomic_cas(volatile int32_t *ptr, int32_t oldval, int32_t newval)
+{
+	int32_t val;
+	
+	CRITICAL_ENTER();
+	val = *ptr;
+	if (val == oldval)
+		*ptr = newval;
+	CRITICAL_LEAVE();
+	
+	return val;
+}
+
+/*
+ * High resolution timer hardware. Architectures with a free running compare
+ * timer implement _hrtimer_set() in the HAL, programming an interrupt at an
+ * absolute deadline (in the time base of _read_us()) which calls
+ * krnl_hrtimer_handler(). A deadline of 0 disables the hardware timer. The
+ * default implementation has no hardware support and always fails.
+ */
+
+int32_t hrtimer_set(uint64_t deadline)
+{
+	return ERR_FAIL;
+}
+
+/*
+ * Cycle counter. Architectures with a free running counter (such as mcycle,
+ * DWT->CYCCNT or a hardware timer) implement both _read_cycles() and
+ * _cycles_freq() in the HAL. If the counter frequency is not known, the HAL
+ * returns 0 and the counter is calibrated against _read_us() at boot (so
+ * _read_us() must not depend on interrupts). The default counter is
+ * _read_us() itself, counting at 1MHz.
+ */
+
+uint64_t read_cycles(void)
+{
+	return _read_us();
+}
+
+uint32_t cycles_freq(void)
+{
+	return 1000000;
+}
+
+
+/*
+ * Kernel wait lists, used by blocking IPC primitives. A wait list holds tasks
+ * sorted by priority (FIFO among tasks of the same priority), so the highest
+ * priority waiter is always the first one to be released. Waiters are linked
+ * through their TCB (a task waits on a single list at a time), so blocking and
+ * releasing a task never allocate memory and a waiter is unlinked in constant
+ * time.
+ * 
+ * krnl_block() must be called inside a critical section. The current task is
+ * inserted in the wait list and blocked for at most 'timeout' ticks (the task
+ * delay mechanism is used, so WAIT_FOREVER blocks without a delay and 0 does
+ * not block at all). The critical section is left while the task is blocked
+ * and is entered again before returning. If the task is still on the list when
+ * it resumes execution, nobody released it and the wait timed out.
+ * 
+ * krnl_block() is split in krnl_wlist_insert(), which queues and blocks the
+ * current task, and krnl_wlist_yield(), which waits to be released. Both are
+ * used directly when something must be done after the task is queued and
+ * before it yields, in the same critical section.
+ * 
+ * krnl_unblock() removes the first waiter from the list and makes it ready to
+ * run, and krnl_release() does the same for a specific waiter. The caller may
+ * pass data to the released task using its 'wdata' field.
+ */
+
+struct wlist_s *krnl_wlist_create(void)
+{
+	struct wlist_s *wlist;
+	
+	wlist = malloc(sizeof(struct wlist_s));
+	
+	if (!wlist)
+		return 0;
+	
+	wlist->head = 0;
+	wlist->length = 0;
+	
+	return wlist;
+}
+
+int32_t krnl_wlist_destroy(struct wlist_s *wlist)
+{
+	if (wlist->head)
+		return -1;
+	
+	free(wlist);
+	
+	return 0;
+}
+
+static void wlist_unlink(struct tcb_s *task)
+{
+	*task->wpprev = task->wnext;
+	if (task->wnext)
+		task->wnext->wpprev = task->wpprev;
+	task->wlist->length--;
+	task->wnext = 0;
+	task->wpprev = 0;
+	task->wlist = 0;
+}
+
+void krnl_wlist_insert(struct wlist_s *wlist, void *data, uint16_t timeout)
+{
+	struct tcb_s *task = kcb->task_current->data;
+	struct tcb_s **pp;
+	
+	for (pp = &wlist->head; *pp; pp = &(*pp)->wnext)
+		if (((*pp)->priority >> 8) > (task->priority >> 8))
+			break;
+	
+	task->wnext = *pp;
+	if (task->wnext)
+		task->wnext->wpprev = &task->wnext;
+	task->wpprev = pp;
+	*pp = task;
+	task->wlist = wlist;
+	wlist->length++;
+	
+	task->wdata = data;
+	task->delay = timeout == WAIT_FOREVER ? 0 : timeout;
+	task->state = TASK_BLOCKED;
+}
+
+int32_t krnl_wlist_yield(void)
+{
+	struct tcb_s *task = kcb->task_current->data;
+	
+	CRITICAL_LEAVE();
+	ucx_task_yield();
+	CRITICAL_ENTER();
+	
+	if (task->wlist) {
+		wlist_unlink(task);
+		
+		return ERR_TIMEOUT;
+	}
+	
+	return ERR_OK;
+}
+
+int32_t krnl_block(struct wlist_s *wlist, void *data, uint16_t timeout)
+{
+	if (!timeout)
+		return ERR_TIMEOUT;
+	
+	krnl_wlist_insert(wlist, data, timeout);
+	
+	return krnl_wlist_yield();
+}
+
+struct tcb_s *krnl_unblock(struct wlist_s *wlist)
+{
+	return krnl_release(wlist->head);
+}
+
+struct tcb_s *krnl_release(struct tcb_s *task)
+{
+	if (task && task->wlist) {
+		wlist_unlink(task);
+		task->delay = 0;
+		task->state = TASK_READY;
+	}
+	
+	return task;
+}
+
+/*
+ * periodic task release, called by the timer handler when a timer bound to a
+ * task expires (out of a critical section). a release that arrives while the
+ * previous one was not consumed yet (the task didn't reach ucx_timer_wait()
+ * in time) is counted as an overrun of the task.
+ */
+int32_t krnl_task_release(uint16_t id)
+{
+	struct tcb_s *task;
+	
+	CRITICAL_ENTER();
+	task = krnl_task_lookup(id);
+	
+	if (!task) {
+		CRITICAL_LEAVE();
+		
+		return ERR_TASK_NOT_FOUND;
+	}
+	
+	if (task->releases)
+		task->overruns++;
+	if (task->releases < 0xffff)
+		task->releases++;
+	
+	if (task->state == TASK_BLOCKED && task->rwait) {
+		task->rwait = 0;
+		task->delay = 0;
+		task->state = TASK_READY;
+	}
+	CRITICAL_LEAVE();
+	
+	return ERR_OK;
+}
+
+
 /* task management API */
 
 int32_t ucx_task_spawn(void *task, uint16_t stack_size)
@@ -204,6 +486,9 @@ int32_t ucx_task_spawn(void *task, uint16_t stack_size)
 	if (!new_tcb)
 		krnl_panic(ERR_TCB_ALLOC);
 
+	if (kcb->id_next >= task_tbl_size && task_tbl_grow(kcb->id_next))
+		krnl_panic(ERR_TCB_ALLOC);
+
 	CRITICAL_ENTER();
 	
 	new_task = list_pushback(kcb->tasks, new_tcb);
@@ -214,9 +499,21 @@ int32_t ucx_task_spawn(void *task, uint16_t stack_size)
 	new_task->data = new_tcb;
 	new_tcb->task = task;
 	new_tcb->rt_prio = 0;
+	new_tcb->wdata = 0;
+	new_tcb->wnext = 0;
+	new_tcb->wpprev = 0;
+	new_tcb->wlist = 0;
+	new_tcb->notify = 0;
+	new_tcb->nmask = 0;
+	new_tcb->overruns = 0;
+	new_tcb->releases = 0;
+	new_tcb->rwait = 0;
 	new_tcb->delay = 0;
 	new_tcb->stack_sz = stack_size;
 	new_tcb->id = kcb->id_next++;
+	if (new_tcb->id >= task_tbl_size)
+		krnl_panic(ERR_TCB_ALLOC);
+	task_tbl[new_tcb->id] = new_tcb;
 	new_tcb->state = TASK_STOPPED;
 	new_tcb->priority = TASK_NORMAL_PRIO;
 	new_tcb->stack = malloc(stack_size);
@@ -259,6 +556,9 @@ int32_t ucx_task_cancel(uint16_t id)
 	}
 	
 	task = node->data;
+	if (task->wlist)
+		wlist_unlink(task);
+	task_tbl[task->id] = 0;
 	free(task->stack);
 	free(task);
 	
@@ -342,6 +642,108 @@ int32_t ucx_task_resume(uint16_t id)
 	return ERR_OK;
 }
 
+/*
+ * Task notifications are a lightweight alternative to semaphores and event
+ * flags for signaling a specific task. Each task has a 32 bit notification
+ * word which other tasks or interrupt handlers update (setting bits, using it
+ * as a counter or overwriting it), and a task waits on its own word, so no
+ * kernel objects are allocated.
+ */
+int32_t ucx_task_notify(uint16_t id, uint32_t bits, uint8_t action)
+{
+	struct tcb_s *task;
+
+	CRITICAL_ENTER();
+	task = krnl_task_lookup(id);
+	
+	if (!task) {
+		CRITICAL_LEAVE();
+		
+		return ERR_TASK_NOT_FOUND;
+	}
+	
+	switch (action) {
+	case NOTIFY_SET:
+		task->notify |= bits;
+		break;
+	case NOTIFY_INC:
+		task->notify += bits;
+		break;
+	case NOTIFY_OVERWRITE:
+		task->notify = bits;
+		break;
+	default:
+		CRITICAL_LEAVE();
+		
+		return ERR_FAIL;
+	}
+	
+	if (task->state == TASK_BLOCKED && (task->notify & task->nmask)) {
+		task->nmask = 0;
+		task->delay = 0;
+		task->state = TASK_READY;
+	}
+	CRITICAL_LEAVE();
+	
+	return ERR_OK;
+}
+
+/*
+ * Waits until any bit of 'mask' is set in the current task notification word,
+ * for a number of ticks (or WAIT_FOREVER). The matched bits are cleared and
+ * returned, or 0 if the timeout expired. Counting notifications (NOTIFY_INC)
+ * are consumed all at once using a full mask.
+ */
+uint32_t ucx_task_notify_wait(uint32_t mask, uint16_t timeout)
+{
+	struct tcb_s *task;
+	uint32_t bits;
+	
+	CRITICAL_ENTER();
+	task = kcb->task_current->data;
+	
+	if (!(task->notify & mask) && timeout) {
+		task->nmask = mask;
+		task->delay = timeout == WAIT_FOREVER ? 0 : timeout;
+		task->state = TASK_BLOCKED;
+		CRITICAL_LEAVE();
+		ucx_task_yield();
+		CRITICAL_ENTER();
+		task->nmask = 0;
+	}
+	
+	bits = task->notify & mask;
+	task->notify &= ~bits;
+	CRITICAL_LEAVE();
+	
+	return bits;
+}
+
+/*
+ * Returns (and clears) the number of periodic releases a task missed, i.e.
+ * releases by its bound timer while the previous release was not consumed.
+ */
+int32_t ucx_task_overruns(uint16_t id)
+{
+	struct tcb_s *task;
+	uint32_t overruns;
+	
+	CRITICAL_ENTER();
+	task = krnl_task_lookup(id);
+	
+	if (!task) {
+		CRITICAL_LEAVE();
+	
+		return ERR_TASK_NOT_FOUND;
+	}
+	
+	overruns = task->overruns;
+	task->overruns = 0;
+	CRITICAL_LEAVE();
+	
+	return overruns & 0x7fffffff;
+}
+
 int32_t ucx_task_priority(uint16_t id, uint16_t priority)
 {
 	struct node_s *node;
@@ -453,3 +855,84 @@ uint64_t ucx_uptime()
 {
 	return _read_us() / 1000;
 }
+
+
+/*
+ * Cycle counter conversion. The counter frequency is calibrated once at boot
+ * (if unknown) and cycles are converted to time with multiply-shift constants,
+ * so timestamps can be taken and converted without 64 bit divisions.
+ */
+
+static uint32_t cycles_hz;
+static uint32_t cycles_ns_mult, cycles_us_mult;
+static uint8_t cycles_ns_shift, cycles_us_shift;
+
+/* largest shift which keeps mult = (scale << shift) / freq (rounded) in 32 bits */
+static void cycles_mult(uint32_t scale, uint32_t *mult, uint8_t *shift)
+{
+	uint64_t m = 0;
+	uint8_t s;
+	
+	for (s = 32; s > 0; s--) {
+		m = (((uint64_t)scale << s) + (cycles_hz >> 1)) / cycles_hz;
+		if (m <= 0xffffffff)
+			break;
+	}
+	
+	*mult = m;
+	*shift = s;
+}
+
+/* (cycles * mult) >> shift, without overflowing the 64 bit product */
+static uint64_t cycles_scale(uint64_t cycles, uint32_t mult, uint8_t shift)
+{
+	uint64_t hi, lo;
+	
+	hi = (cycles >> 32) * mult;
+	lo = (cycles & 0xffffffff) * mult;
+	
+	return (hi << (32 - shift)) + (lo >> shift);
+}
+
+void krnl_cycles_init(void)
+{
+	uint64_t c0, c1, t0, t1;
+	
+	cycles_hz = _cycles_freq();
+	
+	if (!cycles_hz) {
+		/* count cycles between two _read_us() edges */
+		t0 = _read_us();
+		while ((t1 = _read_us()) == t0);
+		c0 = _read_cycles();
+		while ((t0 = _read_us()) - t1 < CYCLES_CALIBRATE_US);
+		c1 = _read_cycles();
+		cycles_hz = (c1 - c0) * 1000000 / (t0 - t1);
+		
+		if (!cycles_hz)
+			cycles_hz = 1;
+	}
+	
+	cycles_mult(1000000000, &cycles_ns_mult, &cycles_ns_shift);
+	cycles_mult(1000000, &cycles_us_mult, &cycles_us_shift);
+}
+
+uint64_t ucx_cycles(void)
+{
+	return _read_cycles();
+}
+
+uint32_t ucx_cycles_freq(void)
+{
+	return cycles_hz;
+}
+
+uint64_t ucx_cycles_to_ns(uint64_t cycles)
+{
+	return cycles_scale(cycles, cycles_ns_mult, cycles_ns_shift);
+}
+
+uint64_t ucx_cycles_to_us(uint64_t cycles)
+{
+	return cycles_scale(cycles, cycles_us_mult, cycles_us_shift);
+}
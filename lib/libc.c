@@ -347,6 +347,23 @@ int32_t ucx_abs(int32_t n)
 	return n >= 0 ? n : -n;
 }
 
+/* find first (least significant) bit set, starting at 1. returns 0 if none */
+int32_t ucx_ffs(uint32_t x)
+{
+	int32_t n = 1;
+	
+	if (!x)
+		return 0;
+	
+	if (!(x & 0x0000ffff)) { n += 16; x >>= 16; }
+	if (!(x & 0x000000ff)) { n += 8; x >>= 8; }
+	if (!(x & 0x0000000f)) { n += 4; x >>= 4; }
+	if (!(x & 0x00000003)) { n += 2; x >>= 2; }
+	if (!(x & 0x00000001)) { n += 1; }
+	
+	return n;
+}
+
 
 static uint32_t rand1=0xbaadf00d;
 